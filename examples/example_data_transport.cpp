@@ -0,0 +1,118 @@
+/// @file example_data_transport.cpp
+/// @brief An example demonstrating how to choose the format and the transport
+/// of the data sent to Gnuplot.
+/// @copyright Copyright (c) 2025 Enrico Fraccaroli <enry.frak@gmail.com>
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <gnuplotcpp/gnuplot.hpp>
+
+/// @brief Waits for the user to press Enter before the next plot.
+static void wait_for_enter()
+{
+    std::cout << "Press Enter to continue..." << std::endl;
+    std::cin.get();
+}
+
+int main()
+{
+    using namespace gnuplotcpp;
+
+    // Create a Gnuplot instance
+    Gnuplot gnuplot;
+
+    // Prepare a long series, where the format of the data matters.
+    std::vector<double> x, y;
+    for (unsigned int i = 0; i < 100000; i++) {
+        x.push_back(static_cast<double>(i) * 1e-3); // x[i] = i / 1000
+        y.push_back(std::sin(x[i]) * std::exp(-x[i] * 0.02));
+    }
+
+    // Write the data as text, with six significant digits instead of the
+    // shortest exact representation.
+    gnuplot
+        .set_title("Text data, 6 digits")   // Set plot title
+        .set_grid()                         // Show the grid.
+        .set_plot_style(plot_style_t::lines) // Set the plot style to line.
+        .set_data_format(data_format_t::text)
+        .set_text_precision(6)
+        .plot_xy(x, y, "damped sine");
+    wait_for_enter();
+
+    // Write the same data as binary records, then as single precision floats,
+    // and finally as 16-bit codes scaled back by Gnuplot.
+    gnuplot.set_title("Binary data").set_data_format(data_format_t::binary).reset_plot().plot_xy(x, y, "double");
+    wait_for_enter();
+    gnuplot.set_title("Binary float32 data")
+        .set_data_format(data_format_t::binary_float32)
+        .reset_plot()
+        .plot_xy(x, y, "float");
+    wait_for_enter();
+    gnuplot.set_title("Quantized data")
+        .set_data_format(data_format_t::binary_uint16)
+        .reset_plot()
+        .plot_xy(x, y, "uint16");
+    wait_for_enter();
+
+    // Send several series inline, as datablocks, instead of temporary files.
+    std::vector<std::vector<double>> series(3);
+    for (unsigned int i = 0; i < 200; i++) {
+        series[0].push_back(std::sin(i * 0.05));
+        series[1].push_back(std::cos(i * 0.05));
+        series[2].push_back(std::sin(i * 0.05) * std::cos(i * 0.05));
+    }
+    gnuplot.set_title("Datablocks")
+        .set_data_format(data_format_t::text)
+        .set_text_precision()
+        .set_data_transport(data_transport_t::datablock)
+        .reset_plot()
+        .plot_x(series, std::vector<std::string>{ "sin", "cos", "sin * cos" });
+    wait_for_enter();
+
+    // Store a 3D grid as a matrix, with each coordinate of the axes written once.
+    const unsigned int grid_size = 50;
+    std::vector<double> gx(grid_size), gy(grid_size);
+    std::vector<std::vector<double>> gz(grid_size, std::vector<double>(grid_size));
+    for (unsigned int i = 0; i < grid_size; ++i) {
+        gx[i] = -5.0 + 10.0 * i / (grid_size - 1);
+        gy[i] = -5.0 + 10.0 * i / (grid_size - 1);
+    }
+    for (unsigned int i = 0; i < grid_size; ++i) {
+        for (unsigned int j = 0; j < grid_size; ++j) {
+            gz[i][j] = std::sin(gx[i]) * std::cos(gy[j]);
+        }
+    }
+    gnuplot.set_title("Grid stored as a matrix")
+        .set_data_transport(data_transport_t::file)
+        .set_data_format(data_format_t::binary)
+        .set_grid_layout(grid_layout_t::matrix)
+        .set_surface()
+        .reset_plot()
+        .plot_3d_grid(gx, gy, gz, "sin(x) * cos(y)");
+    wait_for_enter();
+
+    // Plot an image, stored verbatim as a binary array.
+    const unsigned int width = 64, height = 64;
+    std::vector<unsigned char> image(width * height);
+    for (unsigned int row = 0; row < height; ++row) {
+        for (unsigned int column = 0; column < width; ++column) {
+            image[row * width + column] = static_cast<unsigned char>((row ^ column) * 4);
+        }
+    }
+    gnuplot.set_title("Image").reset_plot().plot_image(image.data(), width, height, "pattern");
+    wait_for_enter();
+
+    // Stream the data through a named pipe while Gnuplot reads it. The data
+    // can only be read once, so the plot is saved to a figure.
+    gnuplot.savetofigure("example_data_transport.png", "png")
+        .set_title("Streamed through a named pipe")
+        .set_data_format(data_format_t::binary)
+        .set_data_transport(data_transport_t::fifo)
+        .reset_plot()
+        .plot_xy(x, y, "damped sine")
+        .showonscreen();
+    std::cout << "The last plot was saved to example_data_transport.png" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+/// @file example_datasets.cpp
+/// @brief An example demonstrating how to store data once and plot it several
+/// times, and how to update it in place.
+/// @copyright Copyright (c) 2025 Enrico Fraccaroli <enry.frak@gmail.com>
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <gnuplotcpp/gnuplot.hpp>
+
+/// @brief Waits for the user to press Enter before the next plot.
+static void wait_for_enter()
+{
+    std::cout << "Press Enter to continue..." << std::endl;
+    std::cin.get();
+}
+
+int main()
+{
+    using namespace gnuplotcpp;
+
+    // Create a Gnuplot instance
+    Gnuplot gnuplot;
+
+    // Store the data as binary records, and double buffer the datasets so that
+    // Gnuplot never reads a half written one.
+    gnuplot.set_data_format(data_format_t::binary).set_double_buffering(true);
+
+    // Prepare three columns: x, sin(x) and cos(x).
+    std::vector<double> x, s, c;
+    for (unsigned int i = 0; i < 500; i++) {
+        x.push_back(static_cast<double>(i) * 0.02);
+        s.push_back(std::sin(x[i]));
+        c.push_back(std::cos(x[i]));
+    }
+    dataset_t dataset = gnuplot.create_dataset(x, s, c);
+
+    // Plot two columns of the same dataset, which is written only once.
+    gnuplot.set_title("Dataset")
+        .set_grid()
+        .set_plot_style(plot_style_t::lines)
+        .plot_dataset(dataset, "sin", "1:2")
+        .plot_dataset(dataset, "cos", "1:3");
+    wait_for_enter();
+
+    // Append records at the end of the dataset, the plot is redrawn.
+    std::vector<double> nx, ns, nc;
+    for (unsigned int i = 500; i < 750; i++) {
+        nx.push_back(static_cast<double>(i) * 0.02);
+        ns.push_back(std::sin(nx.back()));
+        nc.push_back(std::cos(nx.back()));
+    }
+    gnuplot.append_dataset(dataset, nx, ns, nc);
+    std::cout << "Version after append: " << gnuplot.get_dataset_version(dataset) << "\n";
+    wait_for_enter();
+
+    // Replace all the records, then only the first hundred.
+    x.insert(x.end(), nx.begin(), nx.end());
+    s.resize(x.size());
+    c.resize(x.size());
+    for (std::size_t i = 0; i < x.size(); i++) {
+        s[i] = std::sin(x[i]) * 0.5;
+        c[i] = std::cos(x[i]) * 0.5;
+    }
+    gnuplot.update_dataset(dataset, x, s, c);
+    std::cout << "Version after update: " << gnuplot.get_dataset_version(dataset) << "\n";
+    wait_for_enter();
+
+    std::vector<double> rx(x.begin(), x.begin() + 100), rs(100, 1.0), rc(100, -1.0);
+    gnuplot.update_dataset_range(dataset, 0, rx, rs, rc);
+    std::cout << "Version after range update: " << gnuplot.get_dataset_version(dataset) << "\n";
+    wait_for_enter();
+
+    // Plot the dataset in 3D, with x as the height of the helix.
+    gnuplot.set_title("Dataset in 3D").reset_plot().splot_dataset(dataset, "helix", "2:3:1");
+    wait_for_enter();
+
+    // Release the dataset, its file is deleted once no plot reads it.
+    gnuplot.remove_dataset(dataset);
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+/// @file example_decimation.cpp
+/// @brief An example demonstrating how to plot series much longer than the
+/// width of the plot, by writing only the points which can be seen.
+/// @copyright Copyright (c) 2025 Enrico Fraccaroli <enry.frak@gmail.com>
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <memory>
+#include <gnuplotcpp/gnuplot.hpp>
+
+/// @brief Waits for the user to press Enter before the next plot.
+static void wait_for_enter()
+{
+    std::cout << "Press Enter to continue..." << std::endl;
+    std::cin.get();
+}
+
+int main()
+{
+    using namespace gnuplotcpp;
+
+    // Create a Gnuplot instance
+    Gnuplot gnuplot;
+
+    // Prepare a noisy series of two million points, with a single spike.
+    const std::size_t size = 2000000;
+    std::vector<double> x(size), y(size);
+    for (std::size_t i = 0; i < size; i++) {
+        x[i] = static_cast<double>(i) * 1e-4;
+        y[i] = std::sin(x[i]) + 0.1 * std::sin(static_cast<double>(i) * 0.37);
+    }
+    y[size / 3] = 5.0;
+
+    // Refuse series holding NaN, infinities, or values outside of [-1000, 1000].
+    gnuplot.set_finite_check(true).set_value_bounds(-1000.0, 1000.0);
+
+    // Keep the first, lowest, highest and last points of each of the 800
+    // pixel columns of the plot: the spike is still drawn.
+    gnuplot.set_title("Min/max decimation")
+        .set_grid()
+        .set_plot_style(plot_style_t::lines)
+        .set_decimation(decimation_t::minmax, 800)
+        .plot_xy(x, y, "minmax");
+    wait_for_enter();
+
+    // Keep one point per pixel column, following the shape of the trend.
+    gnuplot.set_title("LTTB decimation").set_decimation(decimation_t::lttb, 800).reset_plot().plot_xy(x, y, "lttb");
+    wait_for_enter();
+
+    // Reduce error bars to their envelope, one bar per pixel column.
+    std::vector<double> ex, ey, edy;
+    for (std::size_t i = 0; i < 100000; i++) {
+        ex.push_back(static_cast<double>(i) * 1e-3);
+        ey.push_back(std::sin(ex.back()));
+        edy.push_back(0.1 + 0.05 * std::sin(static_cast<double>(i) * 0.1));
+    }
+    gnuplot.set_title("Envelope of the error bars")
+        .set_decimation(decimation_t::minmax, 200)
+        .reset_plot()
+        .plot_xy_erorrbar(ex, ey, edy, erorrbar_style_t::yerrorbars, "envelope");
+    wait_for_enter();
+
+    // Index the series once, then zoom on it: each window costs time
+    // proportional to the width of the plot, whatever its length. The
+    // pyramid shares the series instead of copying it.
+    pyramid_t pyramid = gnuplot.create_pyramid(std::make_shared<const std::vector<double>>(std::move(x)),
+                                               std::make_shared<const std::vector<double>>(std::move(y)));
+    gnuplot.set_decimation(decimation_t::minmax, 800);
+    const double windows[][2] = { { 0.0, 200.0 }, { 60.0, 70.0 }, { 66.6, 66.7 } };
+    for (const auto &window : windows) {
+        gnuplot.set_title("Pyramid window")
+            .set_xrange(window[0], window[1])
+            .reset_plot()
+            .plot_pyramid(pyramid, window[0], window[1], "zoom");
+        wait_for_enter();
+    }
+
+    // Without decimation, every point of the window is written.
+    gnuplot.set_title("Pyramid window without decimation")
+        .set_decimation(decimation_t::none)
+        .set_xrange(66.0, 67.0)
+        .reset_plot()
+        .plot_pyramid(pyramid, 66.0, 67.0, "all points");
+    wait_for_enter();
+
+    // Release the pyramid, which frees the series.
+    gnuplot.remove_pyramid(pyramid);
+
+    return 0;
+}
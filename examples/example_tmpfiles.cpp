@@ -0,0 +1,76 @@
+/// @file example_tmpfiles.cpp
+/// @brief An example demonstrating how to manage the temporary files holding
+/// the data of the plots.
+/// @copyright Copyright (c) 2025 Enrico Fraccaroli <enry.frak@gmail.com>
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <gnuplotcpp/gnuplot.hpp>
+
+/// @brief Prints the storage counters of a session, and of the whole process.
+static void print_stats(const gnuplotcpp::Gnuplot &gnuplot)
+{
+    const gnuplotcpp::storage_stats_t session = gnuplot.get_storage_stats();
+    const gnuplotcpp::storage_stats_t process = gnuplotcpp::Gnuplot::get_process_storage_stats();
+    std::cout << "Session: " << session.files << " files, " << session.bytes_stored << " bytes stored, "
+              << session.bytes_written << " bytes written.\n"
+              << "Process: " << process.files << " files, " << process.bytes_stored << " bytes stored.\n";
+}
+
+int main(int argc, char *argv[])
+{
+    using namespace gnuplotcpp;
+
+    // Remove the files left behind by crashed processes, when the first
+    // session is created.
+    Gnuplot::set_orphan_sweep(true);
+    std::cout << "Orphaned files removed: " << Gnuplot::sweep_orphaned_tmpfiles() << "\n";
+
+    // The first argument selects the directory of the files of all the
+    // sessions, the second one that of this session only.
+    if ((argc > 1) && !Gnuplot::set_default_tmpfile_directory(argv[1])) {
+        std::cerr << "The directory " << argv[1] << " is not writable.\n";
+    }
+
+    // Create a Gnuplot instance
+    Gnuplot gnuplot;
+    if (argc > 2) {
+        gnuplot.set_tmpfile_directory(argv[2]);
+    }
+
+    // Keep at most two unused files for recycling, and never hold more than 64 MiB.
+    gnuplot.set_tmpfile_pool_size(2).set_tmpfile_quota(64 * 1024 * 1024);
+    std::cout << "Temporary directory: " << gnuplot.get_tmpfile_directory() << "\n";
+
+    // Reuse the files holding identical data.
+    gnuplot.set_data_cache(true);
+
+    // Prepare two series.
+    std::vector<double> x, y1, y2;
+    for (unsigned int i = 0; i < 1000; i++) {
+        x.push_back(static_cast<double>(i) * 0.01);
+        y1.push_back(std::sin(x[i]));
+        y2.push_back(std::cos(x[i]));
+    }
+
+    // Alternate between the two series: each new plot releases the files of
+    // the previous one, and the cache finds the data already written.
+    gnuplot.set_grid().set_plot_style(plot_style_t::lines);
+    for (unsigned int i = 0; i < 4; i++) {
+        gnuplot.set_title("Plot " + std::to_string(i))
+            .reset_plot()
+            .plot_xy(x, (i % 2 == 0) ? y1 : y2, (i % 2 == 0) ? "sin" : "cos");
+        std::cout << "Plot " << i << ": " << gnuplot.get_cache_hits() << " cache hits, "
+                  << gnuplot.get_cache_misses() << " cache misses.\n";
+        print_stats(gnuplot);
+        std::cout << "Press Enter to continue..." << std::endl;
+        std::cin.get();
+    }
+
+    // Release the files of the last plot.
+    gnuplot.reset_plot();
+    print_stats(gnuplot);
+
+    return 0;
+}
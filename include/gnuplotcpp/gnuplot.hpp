@@ -14,15 +14,45 @@
 #include <stdexcept>
 #include <cstdio>
 #include <cstdlib> // for getenv()
+#include <cerrno>
+#include <clocale> // for localeconv()
+#include <cmath>
+#include <cstdint>
+#include <cstring> // for std::memcpy()
 #include <list>    // for std::list
+#include <memory>  // for std::shared_ptr
+#include <functional>
+#include <type_traits>
+#include <limits>
+#include <utility>
+#include <algorithm> // for std::max(), std::sort()
+#include <chrono>    // for std::chrono::steady_clock
+#include <iterator>  // for std::istreambuf_iterator
+
+#if defined(__has_include)
+#if __has_include(<charconv>) && (__cplusplus >= 201703L)
+#include <charconv> // for std::to_chars()
+#endif
+#endif
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__TOS_WIN__)
 //defined for 32 and 64-bit environments
-#include <io.h> // for _access(), _mktemp()
+#include <io.h>       // for _access(), _mktemp(), _open()
+#include <fcntl.h>    // for _O_CREAT
+#include <sys/stat.h> // for _S_IWRITE
 
 #elif defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
 //all UNIX-like OSs (Linux, *BSD, MacOSX, Solaris, ...)
-#include <unistd.h> // for access(), mkstemp()
+#include <unistd.h>   // for access(), mkostemp()
+#include <fcntl.h>    // for open()
+#include <sys/stat.h> // for mkfifo()
+#include <sys/uio.h>  // for writev()
+#include <dirent.h>   // for opendir()
+#include <signal.h>   // for kill()
+#if defined(__linux__)
+#include <sys/mman.h> // for memfd_create()
+#include <sys/vfs.h>  // for statfs()
+#endif
 
 #else
 #error unsupported or unknown operating system
@@ -52,6 +82,51 @@ enum class erorrbar_style_t {
     xerrorbars, ///< Error bars along the x-axis.
 };
 
+/// @brief Enum representing how data is serialized before being handed to Gnuplot.
+enum class data_format_t {
+    text,           ///< Human-readable text, one record per line (default).
+    binary,         ///< Raw binary records, each column stored with its native element type.
+    binary_float32, ///< Binary records of single precision floats, lossy for double data.
+    binary_uint16,  ///< Binary records of 16-bit codes, quantized over the range of each column.
+};
+
+/// @brief Enum representing how data is transferred to Gnuplot.
+enum class data_transport_t {
+    file,      ///< Data is stored inside temporary files (default).
+    datablock, ///< Data is sent through the pipe as named datablocks, always as text.
+    fifo,      ///< Data is streamed through a named pipe while Gnuplot reads it (UNIX only), cannot be replotted.
+};
+
+/// @brief Enum representing how plot_3d_grid() lays out the grid data.
+enum class grid_layout_t {
+    points, ///< One (x, y, z) record for each point of the grid (default).
+    matrix, ///< Gnuplot nonuniform matrix: the axes are stored once, followed by z row by row.
+};
+
+/// @brief Enum representing how plot_x() and plot_xy() reduce large series before writing them.
+enum class decimation_t {
+    none,   ///< Every point is written (default).
+    minmax, ///< The first, lowest, highest and last points of each pixel column are written.
+    lttb,   ///< Largest-triangle-three-buckets: a fixed number of points keeping the visual shape.
+};
+
+/// @brief Counters describing the temporary files written by the sessions.
+struct storage_stats_t {
+    unsigned long long bytes_written = 0; ///< Bytes written to temporary files so far.
+    unsigned long long bytes_stored  = 0; ///< Bytes currently held by temporary files.
+    std::size_t files                = 0; ///< Number of temporary files currently alive.
+};
+
+/// @brief Handle to data stored once inside a session, see Gnuplot::create_dataset().
+struct dataset_t {
+    std::size_t id = 0; ///< Identifier of the dataset inside its session, 0 for an invalid handle.
+};
+
+/// @brief Handle to a series indexed for zooming, see Gnuplot::create_pyramid().
+struct pyramid_t {
+    std::size_t id = 0; ///< Identifier of the pyramid inside its session, 0 for an invalid handle.
+};
+
 /// @brief Enum representing the smoothing styles available in Gnuplot.
 enum class smooth_style_t {
     none,      ///< No smoothing (default).
@@ -166,6 +241,11 @@ enum class terminal_type_t {
     xterm         ///< Xterm Tektronix 4014 Mode
 };
 
+namespace detail
+{
+struct quantization_t;
+} // namespace detail
+
 /// @brief Main Gnuplot class for managing plots.
 class Gnuplot {
 public:
@@ -181,6 +261,30 @@ public:
     /// @return `true` if the path was successfully set, `false` otherwise.
     static bool set_gnuplot_path(const std::string &path);
 
+    /// @brief Sets the directory of the temporary files of all the sessions.
+    /// @details By default `TMPDIR` is used when set; otherwise, on Linux, a
+    /// memory-backed filesystem (`/dev/shm` or `$XDG_RUNTIME_DIR`) is preferred
+    /// over `/tmp`. Anonymous memory files and datablocks do not use it.
+    /// @param directory The directory, an empty string restores the default.
+    /// @return `true` if the directory is writable and was set, `false` otherwise.
+    static bool set_default_tmpfile_directory(const std::string &directory);
+
+    /// @brief Enables the removal of the temporary files left behind by crashed processes.
+    /// @details The sweep is disabled by default. When enabled before the first
+    /// session is constructed, that session calls sweep_orphaned_tmpfiles().
+    /// @param enable Whether to sweep the orphaned files (default is true).
+    static void set_orphan_sweep(bool enable = true);
+
+    /// @brief Removes the temporary files left behind by processes which are gone.
+    /// @details Regular temporary files and named pipes are named after the PID
+    /// of their process, tagged with the boot and the PID namespace it belongs to.
+    /// The files of the default temporary directory bearing the tag of the current
+    /// process, and whose process does not exist anymore, are removed; the files of
+    /// other namespaces, which may share the directory, are left alone. Nothing is
+    /// removed where the tag is unavailable (outside Linux, or without `/proc`).
+    /// @return The number of removed files.
+    static std::size_t sweep_orphaned_tmpfiles();
+
     /// @brief Sets the default terminal type for displaying plots.
     /// @param type The terminal type to set (default is "wxt").
     /// @return void
@@ -245,6 +349,186 @@ public:
     /// @return Reference to the current Gnuplot object.
     Gnuplot &set_point_size(double size);
 
+    /// @brief Sets the format used to store the data of the following plots.
+    /// @details In binary mode the values are written verbatim and the generated
+    /// command carries the matching `binary record=N format='...'` clause, which
+    /// skips both the text formatting and the parsing done by Gnuplot. Applies to
+    /// plot_x(), plot_xy(), plot_xyz(), plot_xy_erorrbar() and plot_3d_grid().
+    /// Series whose values are not arithmetic are still written as text.
+    ///
+    /// The lossy binary formats trade precision for size, which is usually
+    /// invisible at screen resolution: single precision floats halve the size of
+    /// double data, while quantized data stores 16-bit codes and lets the
+    /// `using` clause scale them back (`($1*scale+offset)`), a quarter of the
+    /// size of double data with a resolution of 1/65534 of the range of each
+    /// column.
+    /// @param format The data format (default is text).
+    /// @return Reference to the current Gnuplot object.
+    Gnuplot &set_data_format(data_format_t format = data_format_t::text);
+
+    /// @brief Sets how the data of the following plots is transferred to Gnuplot.
+    /// @details With datablocks the data is sent inline through the pipe
+    /// (`$name << EOD ... EOD`) and referenced by name, so no temporary file is
+    /// created. Datablocks only hold text, thus the data format is ignored.
+    /// Applies to plot_x(), plot_xy(), plot_xyz() and plot_3d_grid().
+    ///
+    /// With named pipes (FIFOs) the plot command is sent first, and the data is
+    /// then streamed into the pipe while Gnuplot reads it, so that formatting
+    /// overlaps with the work done by Gnuplot. The data can be read only once:
+    /// a pipe-backed plot cannot be used with replot(), cannot be followed by
+    /// further plots on the same graph (which are issued as replots), and
+    /// cannot be redrawn by interactive terminals (e.g., when zooming). Use it
+    /// for one-shot plots, usually saved to a figure. Applies to plot_x(),
+    /// plot_xy(), plot_xyz() and plot_xy_erorrbar(); other plots, and systems
+    /// without named pipes, use temporary files instead. Sending a plot waits
+    /// at most GP_FIFO_TIMEOUT_MS for Gnuplot to open its pipes; if it does
+    /// not, the following plots use temporary files until the transport is set
+    /// again.
+    /// @param transport The data transport (default is file).
+    /// @return Reference to the current Gnuplot object.
+    Gnuplot &set_data_transport(data_transport_t transport = data_transport_t::file);
+
+    /// @brief Sets how plot_3d_grid() lays out the grid data.
+    /// @details The matrix layout stores each coordinate of the axes once,
+    /// instead of repeating them for every point, which is about a third of the
+    /// data and much faster for Gnuplot to parse. As text it is written as a
+    /// `nonuniform matrix`; with any binary data format it is written as a
+    /// `binary matrix`, whose values are always single precision floats. Grids
+    /// whose values are not arithmetic are laid out as points.
+    /// @param layout The grid layout (default is points).
+    /// @return Reference to the current Gnuplot object.
+    Gnuplot &set_grid_layout(grid_layout_t layout = grid_layout_t::points);
+
+    /// @brief Sets the precision used to write numbers as text.
+    /// @details Text data is always written with a `.` as decimal separator,
+    /// regardless of the global locale.
+    /// @param precision The number of significant digits, a negative value
+    /// selects the shortest representation that reads back to the same value.
+    /// @return Reference to the current Gnuplot object.
+    Gnuplot &set_text_precision(int precision = -1);
+
+    /// @brief Sets how plot_x() and plot_xy() reduce large series before writing them.
+    /// @details With min/max decimation, the x range is split into as many
+    /// buckets as pixel columns, and only the first, lowest, highest and last
+    /// points of each bucket are written, in their original order. The drawn
+    /// line covers the same pixels, spikes included, while the written data no
+    /// longer depends on the length of the series. Points with a non-finite
+    /// coordinate are always kept, so that the gaps of the line are preserved.
+    ///
+    /// LTTB keeps one point per pixel column, the first, the last, and in each
+    /// bucket between them the one forming the largest triangle with its
+    /// neighbours, which follows the shape of smooth trends better. It is made
+    /// for series sorted along x, whose gaps are not preserved.
+    ///
+    /// plot_x() series are written with their index as x coordinate, and
+    /// plot_xy_erorrbar() keeps the envelope of the y error bars whatever the
+    /// mode, with one bar per pixel column. Series whose values are not
+    /// arithmetic are written as they are.
+    ///
+    /// Whatever the mode, `size` is the number of pixel columns, and a series
+    /// is only decimated when it holds more points than the mode writes: more
+    /// than 4 × `size` with min/max decimation, more than `size` with LTTB.
+    /// @param mode The decimation mode (default is none).
+    /// @param size The number of pixel columns of the plot, zero for
+    /// GP_DECIMATION_SIZE. Gnuplot cannot report the size of its terminal
+    /// through the pipe, give the width of the plot when it is known.
+    /// @return Reference to the current Gnuplot object.
+    Gnuplot &set_decimation(decimation_t mode = decimation_t::none, std::size_t size = 0);
+
+    /// @brief Refuses to plot data holding NaN or infinite values.
+    /// @details The columns given to plot_x(), plot_xy(), plot_xyz(),
+    /// plot_xy_erorrbar() and create_pyramid() are checked before any
+    /// decimation, the row indices written for decimated series are not. They
+    /// are scanned with vector instructions when they are contiguous arrays of
+    /// doubles or floats. The check is disabled by default, since Gnuplot draws
+    /// non-finite values as gaps.
+    /// @param enable Whether to check the data (default is true).
+    /// @return Reference to the current Gnuplot object.
+    Gnuplot &set_finite_check(bool enable = true);
+
+    /// @brief Refuses to plot data holding finite values outside of [lower, upper].
+    /// @details Applies to the same plots as set_finite_check(), the default
+    /// infinite bounds disable the check.
+    /// @param lower The lowest allowed value.
+    /// @param upper The highest allowed value.
+    /// @return Reference to the current Gnuplot object.
+    Gnuplot &set_value_bounds(double lower = -std::numeric_limits<double>::infinity(),
+                              double upper = std::numeric_limits<double>::infinity());
+
+    /// @brief Sets how many unused temporary files are kept for recycling.
+    /// @details A new plot (not a replot) releases the files of the previous one,
+    /// as does reset_plot(). Released files are rewritten by the following plots
+    /// instead of creating new ones, the least recently used first; when more
+    /// than `size` of them are waiting, the least recently used are deleted.
+    /// With a size of zero, the files are deleted as soon as the plots on screen
+    /// no longer read them. Released datablocks are always undefined.
+    ///
+    /// Gnuplot reads its commands asynchronously, so a released file is only
+    /// rewritten or deleted once Gnuplot has executed the commands reading it.
+    /// On UNIX-like systems, when more than `size` files are waiting, Gnuplot
+    /// is asked to write a marker file after these commands; the session does
+    /// not wait for it, the exceeding files are deleted by a later plot once
+    /// the marker is written. Only making room for the quota waits for it, at
+    /// most GP_FIFO_TIMEOUT_MS. Elsewhere, the files released by a plot are
+    /// assumed read once the next new plot is sent.
+    /// @param size The maximum number of unused files kept (default is GP_MAX_TMP_FILES).
+    /// @return Reference to the current Gnuplot object.
+    Gnuplot &set_tmpfile_pool_size(std::size_t size);
+
+    /// @brief Sets the directory of the temporary files of this session.
+    /// @param directory The directory, an empty string restores the default
+    /// one (see set_default_tmpfile_directory()).
+    /// @return Reference to the current Gnuplot object.
+    Gnuplot &set_tmpfile_directory(const std::string &directory);
+
+    /// @brief Gives the directory where this session creates its temporary files.
+    /// @return The directory, empty for the working directory.
+    std::string get_tmpfile_directory() const;
+
+    /// @brief Limits the bytes held by the temporary files of this session.
+    /// @details When a write would exceed the quota, the files which no plot
+    /// reads anymore are deleted, least recently used first. If that is not
+    /// enough the write fails, and the plot is not drawn.
+    /// @param bytes The maximum number of bytes, zero for no limit.
+    /// @return Reference to the current Gnuplot object.
+    Gnuplot &set_tmpfile_quota(std::size_t bytes);
+
+    /// @brief Double buffers the datasets created from now on.
+    /// @details update_dataset() then writes the new records to a shadow file,
+    /// and renames it over the published one, so Gnuplot never reads a half
+    /// written dataset. These datasets are regular files, even when anonymous
+    /// memory files are available. On Windows the rename is not atomic.
+    /// @param enable Whether to double buffer the new datasets (default is true).
+    /// @return Reference to the current Gnuplot object.
+    Gnuplot &set_double_buffering(bool enable = true);
+
+    /// @brief Gives the counters of the temporary files of this session.
+    /// @return The storage counters of this session.
+    storage_stats_t get_storage_stats() const;
+
+    /// @brief Gives the counters of the temporary files of all the sessions of the process.
+    /// @return The storage counters of the process.
+    static storage_stats_t get_process_storage_stats();
+
+    /// @brief Enables the reuse of temporary files holding identical data.
+    /// @details Before writing the columns of a plot to a file, their values are
+    /// hashed together with their encoding; when a file of the session which is
+    /// still alive (used or waiting in the pool) holds the same hash, the plot
+    /// reads that file instead of writing a new one. The cache is disabled by
+    /// default, since hashing costs an extra pass over the data of every plot,
+    /// which only pays off when the same data is plotted again.
+    /// @param enable Whether the cache is enabled (default is true).
+    /// @return Reference to the current Gnuplot object.
+    Gnuplot &set_data_cache(bool enable = true);
+
+    /// @brief Gives the number of plots which reused a file from the cache.
+    /// @return The number of cache hits.
+    std::size_t get_cache_hits() const;
+
+    /// @brief Gives the number of plots which did not find their data in the cache.
+    /// @return The number of cache misses.
+    std::size_t get_cache_misses() const;
+
     /// @brief Sets the line width for the current Gnuplot session.
     /// @param width The desired line width. Must be greater than 0.
     /// @return Reference to the current Gnuplot object.
@@ -458,6 +742,7 @@ public:
     Gnuplot &plot_x(const X &x, const std::string &title = "");
 
     /// @brief Plots multiple vectors with separate titles.
+    /// @details All the vectors are stored inside a single data source.
     /// @tparam X The type of the data in the vectors.
     /// @param datasets The vectors of datasets to plot.
     /// @param titles The titles for each vector.
@@ -476,6 +761,11 @@ public:
     Gnuplot &plot_xy(const X &x, const Y &y, const std::string &title = "");
 
     /// @brief Plots x, y pairs with error bars (x, y, dy).
+    /// @details When a decimation mode is set (see set_decimation()), series
+    /// with y error bars longer than the limit of the mode are reduced to one
+    /// bar per pixel column: the mean point of the column, with a bar from the lowest `y - dy`
+    /// to the highest `y + dy` of its points, so that the drawn envelope is
+    /// unchanged. Points with a non-finite value keep their own bar.
     /// @tparam X The type of the x data.
     /// @tparam Y The type of the y data.
     /// @tparam E The type of the error data.
@@ -533,7 +823,9 @@ public:
     Gnuplot &plot_equation3d(const std::string &equation, const std::string &title = "");
 
     /// @brief Plots an image.
-    /// @param ucPicBuf The image data buffer.
+    /// @details The buffer is stored verbatim and read by Gnuplot as a binary
+    /// array of unsigned chars, one row after the other.
+    /// @param ucPicBuf The image data buffer (iWidth x iHeight values, row-major).
     /// @param iWidth The width of the image.
     /// @param iHeight The height of the image.
     /// @param title The title of the plot (default is an empty string).
@@ -543,13 +835,116 @@ public:
                         const unsigned int iHeight,
                         const std::string &title = "");
 
+    /// @brief Stores the given columns inside a temporary file held by the session.
+    /// @details The records are written with the current data format (the
+    /// quantized format is replaced by the binary one), and the file stays
+    /// alive until remove_dataset() is called and no plot reads it anymore.
+    /// @param columns The columns, all of the same size.
+    /// @return The handle of the dataset, invalid on failure.
+    template <typename... Columns>
+    dataset_t create_dataset(const Columns &...columns);
+
+    /// @brief Plots the columns of a dataset, up to its last record.
+    /// @details A dataset can be plotted any number of times, with other
+    /// columns, styles or titles, or in several multiplot panels, while its
+    /// records are written only once.
+    /// @param dataset The dataset to plot.
+    /// @param title The title of the plot (default is an empty string).
+    /// @param columns The Gnuplot `using` specification, such as "1:3" or
+    /// "1:($2*2)" (default is all the columns, in order).
+    /// @return A reference to the current Gnuplot object.
+    Gnuplot &plot_dataset(const dataset_t &dataset, const std::string &title = "", const std::string &columns = "");
+
+    /// @brief Plots the columns of a dataset in 3D, up to its last record.
+    /// @param dataset The dataset to plot.
+    /// @param title The title of the plot (default is an empty string).
+    /// @param columns The Gnuplot `using` specification, such as "1:2:4"
+    /// (default is all the columns, in order).
+    /// @return A reference to the current Gnuplot object.
+    Gnuplot &splot_dataset(const dataset_t &dataset, const std::string &title = "", const std::string &columns = "");
+
+    /// @brief Appends records at the end of a dataset.
+    /// @details Only the new records are written, which makes growing series
+    /// cheap to refresh. When the current plot reads the dataset, it is replotted.
+    /// @param dataset The dataset to extend.
+    /// @param columns The new values of each column, of the same types as those of the dataset.
+    /// @return A reference to the current Gnuplot object.
+    template <typename... Columns>
+    Gnuplot &append_dataset(const dataset_t &dataset, const Columns &...columns);
+
+    /// @brief Replaces all the records of a dataset.
+    /// @details Double buffered datasets (see set_double_buffering()) are
+    /// swapped atomically, the others are rewritten in place. When the current
+    /// plot reads the dataset, it is replotted.
+    /// @param dataset The dataset to update.
+    /// @param columns The new values of each column, of the same types as those of the dataset.
+    /// @return A reference to the current Gnuplot object.
+    template <typename... Columns>
+    Gnuplot &update_dataset(const dataset_t &dataset, const Columns &...columns);
+
+    /// @brief Replaces a range of records of a dataset.
+    /// @details Binary records have a fixed size, so only the new ones are
+    /// written, in place. Text datasets, and double buffered ones, are written
+    /// again as a whole. When the current plot reads the dataset, it is replotted.
+    /// @param dataset The dataset to update.
+    /// @param first The index of the first record to replace.
+    /// @param columns The new values of each column, of the same types as those of the dataset.
+    /// @return A reference to the current Gnuplot object.
+    template <typename... Columns>
+    Gnuplot &update_dataset_range(const dataset_t &dataset, std::size_t first, const Columns &...columns);
+
+    /// @brief Gives the version of a dataset, incremented by each change of its records.
+    /// @param dataset The dataset.
+    /// @return The version, zero when created or when the handle is invalid.
+    std::size_t get_dataset_version(const dataset_t &dataset);
+
+    /// @brief Releases a dataset, its file is deleted once no plot reads it.
+    /// @param dataset The dataset to release, invalidated.
+    /// @return A reference to the current Gnuplot object.
+    Gnuplot &remove_dataset(dataset_t &dataset);
+
+    /// @brief Indexes a series for plot_pyramid(), which draws any x window of it at the resolution of the plot.
+    /// @details The pyramid shares the series with the caller instead of
+    /// copying it, and keeps it alive until it is released; the series must
+    /// not change meanwhile. The first lowest and highest values of each block
+    /// of GP_PYRAMID_STRIDE points are found, then those of blocks twice as
+    /// large, and so on. The index takes about a quarter of the memory of the
+    /// series with the default stride.
+    /// @param x The x coordinates, finite and sorted in increasing order.
+    /// @param y The y coordinates.
+    /// @return The handle of the pyramid, invalid on failure.
+    pyramid_t create_pyramid(std::shared_ptr<const std::vector<double>> x, std::shared_ptr<const std::vector<double>> y);
+
+    /// @brief Plots the points of an indexed series inside an x window.
+    /// @details The window keeps its outer neighbours, so that lines reach
+    /// its edges. Without decimation, all its points are written. Otherwise,
+    /// when it holds more points than the decimation limit (see set_decimation()),
+    /// the smallest blocks of the pyramid giving at most two blocks per pixel
+    /// column are drawn through their lowest and highest points, in every mode.
+    /// The blocks crossing the edges of the window only keep the points inside
+    /// it, found through the smaller blocks they hold. This costs time
+    /// proportional to the number of written points, whatever the length of
+    /// the series. Gaps of the series are not kept in that case.
+    /// Use set_xrange() to zoom on the same window.
+    /// @param pyramid The indexed series.
+    /// @param xmin The lowest x coordinate of the window.
+    /// @param xmax The highest x coordinate of the window.
+    /// @param title The title of the plot (default is an empty string).
+    /// @return A reference to the current Gnuplot object.
+    Gnuplot &plot_pyramid(const pyramid_t &pyramid, double xmin, double xmax, const std::string &title = "");
+
+    /// @brief Releases an indexed series.
+    /// @param pyramid The pyramid to release, invalidated.
+    /// @return A reference to the current Gnuplot object.
+    Gnuplot &remove_pyramid(pyramid_t &pyramid);
+
     /// @brief Repeats the last plot or splot command.
     /// @details Useful for viewing the same plot with different settings or generating it for multiple devices (e.g., screen or file).
     /// @return A reference to the current Gnuplot object.
     Gnuplot &replot();
 
     /// @brief Resets the current Gnuplot session.
-    /// @details The next plot will erase all previous ones.
+    /// @details The next plot will erase all previous ones, the data they read is released.
     /// @return A reference to the current Gnuplot object.
     Gnuplot &reset_plot();
 
@@ -571,28 +966,201 @@ private:
 
     /// @brief Creates a unique temporary file and returns its name.
     ///
-    /// This function generates a temporary file with a unique name
-    /// using platform-specific methods (`_mktemp` on Windows and `mkstemp` on Unix).
-    /// It ensures that the maximum allowed number of temporary files is not exceeded.
-    /// The file is opened for writing, and its name is stored for cleanup.
+    /// The file comes from the first of these paths which applies:
+    ///  - Recycled: the least recently used file which no plot reads anymore,
+    ///    and which Gnuplot is done with, is reopened and truncated (see
+    ///    find_unused_tmpfile()). Only files with a name are recycled for a
+    ///    `named` request.
+    ///  - Anonymous: on Linux, unless `named` is set or `GP_NO_MEMFD` is
+    ///    defined, the file is an anonymous memory file (`memfd_create` with
+    ///    `MFD_CLOEXEC`), reached through its `/proc/<pid>/fd/<n>` entry. It
+    ///    never touches a filesystem and is reclaimed by the kernel as soon as
+    ///    the process exits.
+    ///  - Named: a file is created from tmpfile_template() in the temporary
+    ///    directory, with `mkostemp` on Unix and `_mktemp` then `_open` on
+    ///    Windows. This path is also taken when `memfd_create` is unavailable.
     ///
-    /// @param tmp A reference to an `std::ofstream` object where the file will be opened.
+    /// The number of files is not capped here: the unused ones beyond the pool
+    /// size are deleted by trim_tmpfiles(), and those exceeding the quota by
+    /// account_bytes() while writing.
+    /// The descriptor used to create the file is kept open for writing, and its
+    /// name is stored for cleanup.
     ///
-    /// @return The name of the created temporary file.
+    /// @param fd Receives the descriptor open for writing, which the caller closes
+    ///         unless the file is an anonymous memory file.
     ///
-    /// @throws GnuplotException If the maximum number of temporary files is reached
-    ///         or if the temporary file cannot be created or opened.
-    std::string create_tmpfile(std::ofstream &tmp);
+    /// @param named Whether the file must have a name in a filesystem, which
+    ///         excludes anonymous memory files.
+    ///
+    /// @return The name of the created temporary file, or an empty string on failure.
+    std::string create_tmpfile(int &fd, bool named = false);
+
+    /// @brief Finds the default directory of the temporary files.
+    /// @return The directory, empty for the working directory.
+    static std::string detect_tmpfile_directory();
+
+    /// @brief Gives the directory of the temporary files of the sessions without their own.
+    /// @return The directory, empty for the working directory.
+    static std::string default_tmpfile_directory();
+
+    /// @brief Gives the template passed to `mkostemp` to create a temporary file.
+    std::string tmpfile_template() const;
+
+    /// @brief Identifies the boot and the PID namespace of the process, inside which its PID is meaningful.
+    /// @return A hexadecimal tag, or an empty string if they cannot be identified.
+    static std::string process_tag();
+
+    /// @brief Writes several datasets inside a single data source.
+    /// @details Text data holds one block per dataset, binary data one column
+    /// per dataset, where shorter datasets are padded with NaN.
+    /// @param datasets The datasets.
+    /// @param indices The indices of the datasets to write.
+    /// @return The data source of each written dataset, to place in a plot command, or an empty vector on failure.
+    template <typename X>
+    std::vector<std::string> write_datasets(const std::vector<X> &datasets, const std::vector<size_t> &indices);
+
+    /// @brief Checks the values of the columns against the enabled checks.
+    /// @details Plotting functions pass the columns of the caller, before any decimation.
+    /// @param rows The number of rows to check.
+    /// @param columns The columns.
+    /// @return `true` if the values can be plotted, `false` otherwise.
+    template <typename... Columns>
+    bool check_values(std::size_t rows, const Columns &...columns) const;
+
+    /// @brief Selects the points of a series kept by the decimation.
+    /// @param x The x coordinates.
+    /// @param y The y coordinates.
+    /// @param indices Receives the indices of the kept points, in increasing order.
+    /// @return `true` if the series is decimated, `false` if all its points are written.
+    template <typename X, typename Y>
+    bool decimate(const X &x, const Y &y, std::vector<std::size_t> &indices) const;
+
+    /// @brief Gives the number of points above which series are decimated.
+    /// @return The number of points the decimation mode writes at most, zero without decimation.
+    std::size_t decimation_limit() const;
+
+    /// @brief Writes a grid, one (x, y, z) record for each point.
+    /// @param x The x coordinates.
+    /// @param y The y coordinates.
+    /// @param z The z values (size: x.size() × y.size()).
+    /// @return The data source to place in a plot command, or an empty string on failure.
+    template <typename X, typename Y, typename Z>
+    std::string write_grid(const X &x, const Y &y, const Z &z);
+
+    /// @brief Writes a grid as a Gnuplot nonuniform matrix.
+    /// @param x The x coordinates.
+    /// @param y The y coordinates.
+    /// @param z The z values (size: x.size() × y.size()).
+    /// @return The data source to place in a plot command, or an empty string on failure.
+    template <typename X, typename Y, typename Z>
+    std::string write_matrix(const X &x, const Y &y, const Z &z);
+
+    /// @brief Destination of the serialized data of a single plot.
+    struct data_sink_t {
+        std::string name;                ///< The temporary file name, the datablock name, or the pipe name.
+        int fd = -1;                     ///< The write end of the file or named pipe.
+        std::string buffer;              ///< Data being serialized.
+        std::vector<std::string> chunks; ///< Full buffers waiting for a single vectored write.
+        data_transport_t transport = data_transport_t::file; ///< Where the data goes.
+        std::size_t size = 0;            ///< The number of bytes accounted for the sink.
+        std::chrono::steady_clock::time_point deadline; ///< Time limit for Gnuplot to open a named pipe.
+    };
+
+    /// @brief Writer streaming data into a named pipe, once the plot command reading it is sent.
+    struct pending_write_t {
+        std::string name;                         ///< The name of the named pipe.
+        std::function<bool(data_sink_t &)> write; ///< Writes the data to the sink of the pipe, and closes it.
+    };
+
+    /// @brief Discards the data written for a plot command when leaving a plotting function.
+    /// @details Writers are run by send_cmd(), a plotting function leaving early
+    /// must not let them refer to its data once it has returned.
+    struct plot_guard_t {
+        Gnuplot &gnuplot; ///< The session the plot command is built for.
+        ~plot_guard_t() { gnuplot.discard_pending(); }
+    };
+
+    /// @brief Discards the data written for a plot command which was not sent.
+    /// @details The named pipes are removed, and the files lose the references of the command.
+    void discard_pending();
+
+    /// @brief Removes a named pipe which will not be written, ending the read of Gnuplot if it started.
+    /// @param name The name of the named pipe.
+    void release_fifo(const std::string &name);
+
+    /// @brief Opens the destination for a new block of data.
+    /// @details Named pipes are only created here, they are opened by the first
+    /// flush, once Gnuplot has started reading them.
+    /// @param sink The sink to open.
+    /// @param transport The transport to use.
+    /// @param named Whether a file must have a name in a filesystem (see create_tmpfile()).
+    /// @return `true` on success, `false` otherwise.
+    bool open_sink(data_sink_t &sink, data_transport_t transport, bool named = false);
+
+    /// @brief Writes data straight to the destination of the sink, bypassing its buffer.
+    /// @param sink The sink to write to.
+    /// @param data The data to write.
+    /// @param size The number of bytes to write.
+    /// @return `true` on success, `false` otherwise.
+    bool write_sink(data_sink_t &sink, const char *data, std::size_t size);
+
+    /// @brief Moves the data buffered inside the sink towards its destination.
+    /// @details Files and named pipes queue full buffers, and write them together
+    /// once GP_WRITE_VECTOR_SIZE buffers are waiting.
+    /// @param sink The sink to flush.
+    /// @return `true` on success, `false` otherwise.
+    bool flush_sink(data_sink_t &sink);
+
+    /// @brief Writes all the buffers queued inside the sink with a single vectored write.
+    /// @param sink The sink to write.
+    /// @return `true` on success, `false` otherwise.
+    bool write_chunks(data_sink_t &sink);
+
+    /// @brief Accounts for the bytes about to be written to the file of the sink, enforcing the quota.
+    /// @param sink The sink being written.
+    /// @param size The number of bytes.
+    /// @return `true` if the bytes can be written, `false` if they exceed the quota.
+    bool account_bytes(data_sink_t &sink, std::size_t size);
+
+    /// @brief Waits for Gnuplot to open the named pipe of the sink, and opens its write end.
+    /// @param sink The sink to connect.
+    /// @return `true` on success, `false` otherwise.
+    bool connect_fifo(data_sink_t &sink);
+
+    /// @brief Flushes and closes the sink.
+    /// @param sink The sink to close.
+    /// @return The reference to the data to place in a plot command (the quoted
+    /// file name or the datablock name), or an empty string on failure.
+    std::string close_sink(data_sink_t &sink);
+
+    /// @brief Writes the given columns to an open sink, one record per row, and closes it.
+    /// @param sink The sink receiving the data.
+    /// @param format The format of the records.
+    /// @param quantization The quantization of each column, used by quantized formats.
+    /// @param rows The number of rows, all the columns must have at least this size.
+    /// @param columns The columns to write.
+    /// @return `true` on success, `false` otherwise.
+    template <typename... Columns>
+    bool write_records(data_sink_t &sink,
+                       data_format_t format,
+                       const detail::quantization_t *quantization,
+                       std::size_t rows,
+                       const Columns &...columns);
+
+    /// @brief Writes the given columns, one record per row.
+    /// @details The records are stored according to the current data format and transport.
+    /// @param rows The number of rows, all the columns must have at least this size.
+    /// @param columns The columns to write.
+    /// @return The data source to place in a plot command (the quoted file name
+    /// or datablock name, followed by the binary clause if needed, and by the
+    /// `using` clause), or an empty string on failure.
+    template <typename... Columns>
+    std::string write_columns(std::size_t rows, const Columns &...columns);
 
     /// @brief Checks if the Gnuplot executable path is valid.
     /// @return `true` if the Gnuplot path is found, `false` otherwise.
     static bool get_program_path();
 
-    /// @brief Checks if a file is available for use.
-    /// @param filename The name of the file to check.
-    /// @return `true` if the file exists and is accessible, `false` otherwise.
-    static bool file_ready(const std::string &filename);
-
     /// @brief Checks if a file exists and satisfies the specified mode.
     /// @param filename The name of the file to check.
     /// @param mode The access mode to check (e.g., read, write, execute). Defaults to 0 (existence only).
@@ -669,6 +1237,30 @@ private:
     point_style_t point_style;
     /// @brief Specifies the size of points.
     double point_size = -1.0;
+    /// @brief The format used to store plotted data.
+    data_format_t data_format;
+    /// @brief How plotted data is transferred to Gnuplot.
+    data_transport_t data_transport;
+    /// @brief Whether Gnuplot failed to open a named pipe in time, the following plots then use files.
+    bool fifo_stalled;
+    /// @brief How plot_3d_grid() lays out the grid data.
+    grid_layout_t grid_layout;
+    /// @brief Significant digits of numbers written as text, negative for the shortest round-trip form.
+    int text_precision;
+    /// @brief How plot_x() and plot_xy() reduce large series.
+    decimation_t decimation;
+    /// @brief Number of pixel columns decimated series are reduced to.
+    std::size_t decimation_size;
+    /// @brief Whether plots refuse non-finite values.
+    bool finite_check;
+    /// @brief Lowest finite value accepted by plots.
+    double value_lower;
+    /// @brief Highest finite value accepted by plots.
+    double value_upper;
+    /// @brief number of datablocks defined in session
+    int ndatablocks;
+    /// @brief Writers streaming data into named pipes, run once the plot command is sent.
+    std::vector<pending_write_t> pending_writes;
 
     struct {
         contour_type_t type   = contour_type_t::none;    ///< Default: no contours
@@ -680,11 +1272,230 @@ private:
         int levels             = 10;                     ///< Number of contour levels
     } contour;
 
+    /// @brief A temporary file or datablock created during the session.
+    /// @details It is reachable while a command waiting to be sent or a plot of
+    /// the current chain of plot/replot commands reads it.
+    struct tmpfile_t {
+        std::string name;           ///< The name used to reach the file.
+        int fd;                     ///< The descriptor keeping an anonymous file alive, -1 for regular files.
+        bool datablock;             ///< Whether this is a datablock instead of a file.
+        unsigned pending;           ///< References from commands which were not sent yet.
+        unsigned refs;              ///< References from the plots of the current chain.
+        unsigned holders;           ///< References from datasets.
+        unsigned long long last_use; ///< When the file was last written or became unreachable.
+        std::size_t size;           ///< The number of bytes held by the file.
+        bool cached;                ///< Whether the hash identifies the content of the file.
+        std::uint64_t hash;         ///< The hash of the data and its encoding.
+        std::string source;         ///< The data source reading the file, with its binary and using clauses.
+
+        /// @brief Whether the file is reachable.
+        bool used() const
+        {
+            return (pending > 0) || (refs > 0) || (holders > 0);
+        }
+    };
+
+    /// @brief Finds a temporary file of the session.
+    /// @param name The name of the file.
+    /// @return The file, or a null pointer if there is none with that name.
+    tmpfile_t *find_tmpfile(const std::string &name);
+
+    /// @brief Opens an existing temporary file for writing.
+    /// @param tmpfile The file to open.
+    /// @param append Whether to write after its content, instead of truncating it.
+    /// @return The descriptor open for writing, or -1 on failure.
+    int reopen_tmpfile(const tmpfile_t &tmpfile, bool append);
+
+    /// @brief Finds the least recently used file which no plot reads, and which Gnuplot is done with.
+    /// @param named Whether to skip the anonymous memory files.
+    /// @param sync Whether to synchronize with Gnuplot when only files it may still read are unused.
+    /// @return The file, or a null pointer if all the files are in use.
+    tmpfile_t *find_unused_tmpfile(bool named = false, bool sync = false);
+
+    /// @brief Whether Gnuplot has executed all the commands reading an unused file.
+    bool is_settled(const tmpfile_t &tmpfile) const;
+
+    /// @brief Hands the references of the last command over to the current chain of plots.
+    /// @param fresh Whether the command starts a new chain, dropping the references of the previous one.
+    void update_tmpfiles(bool fresh);
+
+    /// @brief Collects the unreachable data: datablocks are undefined, while the
+    /// least recently used files exceeding the pool size are deleted once settled.
+    void trim_tmpfiles();
+
+    /// @brief Checks whether Gnuplot executed the commands sent so far, settling the files they released.
+    /// @details On UNIX-like systems, Gnuplot is asked to save its terminal
+    /// settings into a marker file after these commands, and the files are
+    /// settled once the marker holds them. The marker stays pending until
+    /// then, a later call checks it again instead of sending another one.
+    /// @param wait Whether to wait for Gnuplot to catch up, at most GP_FIFO_TIMEOUT_MS.
+    /// @return `true` if the files are settled, `false` if Gnuplot did not catch up yet.
+    bool sync_tmpfiles(bool wait);
+
+    /// @brief Removes the bytes held by a file from the counters, before it is truncated or deleted.
+    void release_bytes(tmpfile_t &tmpfile);
+
     /// @brief list of created tmpfiles.
-    std::vector<std::string> tmpfile_list;
+    std::vector<tmpfile_t> tmpfile_list;
+    /// @brief Maximum number of unused temporary files kept for recycling.
+    std::size_t tmpfile_pool_size;
+    /// @brief Clock ordering the uses of the temporary files.
+    unsigned long long tmpfile_clock;
+    /// @brief Clock of the last release Gnuplot is done with, unused files released up to it are settled.
+    unsigned long long tmpfile_synced;
+    /// @brief Clock when the last new plot was sent.
+    unsigned long long fresh_clock;
+    /// @brief Marker file Gnuplot was asked to write, empty if none is pending.
+    std::string sync_marker;
+    /// @brief Clock when the pending marker was requested, the files released up to it settle with it.
+    unsigned long long sync_clock;
+    /// @brief Directory of the temporary files of this session, empty for the default one.
+    std::string tmpfile_dir;
+    /// @brief Whether files holding identical data are reused.
+    bool data_cache;
+    /// @brief Number of plots which reused a file holding identical data.
+    std::size_t cache_hits;
+    /// @brief Number of plots which did not find a file holding identical data.
+    std::size_t cache_misses;
+    /// @brief Maximum number of bytes held by the temporary files, zero for no limit.
+    std::size_t tmpfile_quota;
+    /// @brief Counters of the temporary files of this session.
+    storage_stats_t session_stats;
+
+    /// @brief Data stored once by create_dataset().
+    struct dataset_entry_t {
+        std::size_t id;       ///< The identifier given to the handle.
+        std::string name;     ///< The name of the file holding the records.
+        data_format_t format; ///< The format of the records.
+        std::string layout;   ///< The binary clause describing the records, empty for text.
+        std::size_t columns;  ///< The number of columns of each record.
+        std::size_t rows;     ///< The number of records.
+        std::size_t version;  ///< The number of changes of the records.
+        bool double_buffered; ///< Whether updates are written to a shadow file renamed over this one.
+    };
+
+    /// @brief How write_dataset() writes the records.
+    enum class dataset_write_t {
+        create,  ///< Creates the file of the dataset.
+        append,  ///< Writes after the existing records.
+        replace, ///< Replaces the existing records.
+    };
+
+    /// @brief Datasets of the session.
+    std::vector<dataset_entry_t> dataset_list;
+    /// @brief Number of datasets created during the session.
+    std::size_t ndatasets;
+    /// @brief Whether the new datasets are double buffered.
+    bool double_buffering;
+
+    /// @brief Series indexed by create_pyramid().
+    struct pyramid_entry_t {
+        std::size_t id;                           ///< The identifier given to the handle.
+        std::shared_ptr<const std::vector<double>> x; ///< The x coordinates, shared with the caller.
+        std::shared_ptr<const std::vector<double>> y; ///< The y coordinates, shared with the caller.
+        /// @brief The indices of the lowest values of the blocks of each level,
+        /// `-1` for blocks without finite values. Level `k` has blocks of
+        /// `GP_PYRAMID_STRIDE << k` points.
+        std::vector<std::vector<std::size_t>> lowest;
+        /// @brief The indices of the highest values of the blocks of each level.
+        std::vector<std::vector<std::size_t>> highest;
+    };
+
+    /// @brief Pyramids of the session.
+    std::vector<pyramid_entry_t> pyramid_list;
+    /// @brief Number of pyramids created during the session.
+    std::size_t npyramids;
+
+    /// @brief Builds the levels of a pyramid from its series.
+    /// @param entry The pyramid.
+    void build_pyramid(pyramid_entry_t &entry);
+
+    /// @brief Finds the first lowest and highest finite values of the rows [first, last) of an indexed series.
+    /// @details The rows are covered by the largest blocks of the pyramid they
+    /// hold, only the rows outside of the smallest blocks are scanned.
+    /// @param entry The pyramid.
+    /// @param first The first row.
+    /// @param last The row after the last one.
+    /// @param lowest Receives the row of the lowest value, `-1` if none is finite.
+    /// @param highest Receives the row of the highest value, `-1` if none is finite.
+    static void
+    pyramid_extrema(const pyramid_entry_t &entry, std::size_t first, std::size_t last, std::size_t &lowest, std::size_t &highest);
+
+    /// @brief Finds the dataset of a handle.
+    /// @return The dataset, or a null pointer if the handle is invalid.
+    dataset_entry_t *find_dataset(const dataset_t &dataset);
+
+    /// @brief Checks the columns given for a dataset.
+    /// @param entry The dataset.
+    /// @param create Whether the columns create the dataset, instead of matching its types.
+    /// @param layout Receives the binary clause describing the records, empty for text.
+    /// @param rows Receives the number of records.
+    /// @param columns The columns.
+    /// @return `true` if the columns fit the dataset, `false` otherwise.
+    template <typename... Columns>
+    bool check_dataset(const dataset_entry_t &entry,
+                       bool create,
+                       std::string &layout,
+                       std::size_t &rows,
+                       const Columns &...columns);
+
+    /// @brief Opens the destination of the records of a dataset.
+    /// @param entry The dataset.
+    /// @param sink The sink to open.
+    /// @param mode Whether to create the file, or to append or replace records.
+    /// @param layout The binary clause describing the records, empty for text.
+    /// @return `true` on success, `false` otherwise.
+    bool open_dataset_sink(dataset_entry_t &entry, data_sink_t &sink, dataset_write_t mode, const std::string &layout);
+
+    /// @brief Renames the shadow file of a double buffered dataset over the published one.
+    /// @param entry The dataset.
+    /// @param sink The closed sink.
+    /// @param success Whether the records were written.
+    /// @return `true` on success, `false` otherwise.
+    bool publish_dataset_sink(dataset_entry_t &entry, data_sink_t &sink, bool success);
+
+    /// @brief Replaces a range of records of a dataset.
+    /// @param entry The dataset.
+    /// @param first The index of the first record to replace.
+    /// @param rows The number of records to replace, not zero.
+    /// @param records The serialized records.
+    /// @return `true` on success, `false` otherwise.
+    bool write_dataset_range(dataset_entry_t &entry, std::size_t first, std::size_t rows, const std::string &records);
+
+    /// @brief Increments the version of a dataset, and replots if the current plot reads it.
+    /// @return A reference to the current Gnuplot object.
+    Gnuplot &refresh_dataset(dataset_entry_t &entry);
+
+    /// @brief Writes the records of a dataset.
+    /// @param entry The dataset.
+    /// @param mode Whether to create the file, or to append or replace records.
+    /// @param columns The columns to write.
+    /// @return `true` on success, `false` otherwise.
+    template <typename... Columns>
+    bool write_dataset(dataset_entry_t &entry, dataset_write_t mode, const Columns &...columns);
+
+    /// @brief Sends a plot or splot command reading a dataset.
+    /// @param dataset The dataset to plot.
+    /// @param title The title of the plot.
+    /// @param columns The `using` specification, empty for all the columns.
+    /// @param plane Whether to plot in 2D, instead of 3D.
+    /// @return A reference to the current Gnuplot object.
+    Gnuplot &send_dataset_plot(const dataset_t &dataset,
+                               const std::string &title,
+                               const std::string &columns,
+                               bool plane);
+
+    /// @brief Gives the style, line and point options of the plots.
+    std::string style_options();
 
-    /// @brief number of all tmpfiles (number of tmpfiles restricted)
+    /// @brief number of all tmpfiles, across all sessions
     static int m_tmpfile_num;
+    /// @brief Whether the first session removes the files of crashed processes.
+    static bool m_sweep_orphans;
+    /// @brief Directory of the temporary files of all sessions, empty to detect it.
+    static std::string m_tmpfile_dir;
+    /// @brief Counters of the temporary files of all sessions.
+    static storage_stats_t m_stats;
     /// @brief name of executed GNUPlot file
     static std::string m_gnuplot_filename;
     /// @brief gnuplot path
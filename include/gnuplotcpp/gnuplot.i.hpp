@@ -3,10 +3,28 @@
 
 #pragma once
 
+/// @brief Enables the SSE2 kernels scanning arrays of values, and the AVX2 ones
+/// when the compiler can target them, selected at run time.
+/// @details Available on x86 processors, it can be disabled by defining GP_NO_SIMD.
+#if !defined(GP_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__))
+#define GP_USE_SIMD
+#if defined(__GNUC__) || defined(__clang__)
+#define GP_USE_AVX2
+#define GP_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(__AVX2__)
+#define GP_USE_AVX2
+#define GP_TARGET_AVX2
+#endif
+#endif
+
+#if defined(GP_USE_SIMD)
+#include <immintrin.h> // for the SSE2 and AVX2 kernels
+#endif
+
 namespace gnuplotcpp
 {
 
-/// @brief Maximum number of temporary files allowed.
+/// @brief Default number of unused temporary files kept for recycling.
 /// @details This value is platform-dependent:
 /// - Windows: 27 files (due to OS restrictions).
 /// - UNIX-like systems: 64 files.
@@ -17,7 +35,10 @@ namespace gnuplotcpp
 #endif
 
 // Initialize the static variables
-int Gnuplot::m_tmpfile_num = 0;
+int Gnuplot::m_tmpfile_num     = 0;
+bool Gnuplot::m_sweep_orphans = false;
+std::string Gnuplot::m_tmpfile_dir;
+storage_stats_t Gnuplot::m_stats;
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__TOS_WIN__)
 // Windows-specific static variable initializations
@@ -29,11 +50,29 @@ std::string Gnuplot::m_gnuplot_filename = "gnuplot";
 std::string Gnuplot::m_gnuplot_path     = "/usr/local/bin/";
 #endif
 
-/// Macro to create a temporary file using platform-specific functions
+/// @brief Enables anonymous memory files for temporary data.
+/// @details Available on Linux when `memfd_create` is provided by the C library,
+/// it can be disabled by defining GP_NO_MEMFD.
+#if defined(__linux__) && defined(MFD_CLOEXEC) && !defined(GP_NO_MEMFD)
+#define GP_USE_MEMFD
+#endif
+
+/// Macro to create and open a temporary file using platform-specific functions.
+/// The descriptor is not inherited by the programs the process starts, such as Gnuplot.
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__TOS_WIN__)
+#define CREATE_TEMP_FILE(name)                                                                                         \
+    ((_mktemp(name) == NULL)                                                                                           \
+         ? -1                                                                                                          \
+         : _open(name, _O_CREAT | _O_EXCL | _O_WRONLY | _O_BINARY | _O_NOINHERIT, _S_IREAD | _S_IWRITE))
+#elif defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+#define CREATE_TEMP_FILE(name) mkostemp(name, O_CLOEXEC)
+#endif
+
+/// Macro to close a file descriptor using platform-specific functions
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__TOS_WIN__)
-#define CREATE_TEMP_FILE(name) (_mktemp(name) == NULL)
+#define CLOSE_FILE(fd) _close(fd)
 #elif defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
-#define CREATE_TEMP_FILE(name) (mkstemp(name) == -1)
+#define CLOSE_FILE(fd) close(fd)
 #endif
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__TOS_WIN__)
@@ -54,1522 +93,4280 @@ std::string Gnuplot::m_gnuplot_path     = "/usr/local/bin/";
 #define FILE_ACCESS(file, mode) access(file, mode)
 #endif
 
-Gnuplot::Gnuplot()
-    : gnuplot_pipe(nullptr),               // No active pipe initially
-      terminal_type(terminal_type_t::wxt), // Default terminal type is wxt
-      valid(false),                        // Invalid session by default
-      two_dim(true),                       // 2D plotting by default
-      nplots(0),                           // No plots initially
-      line_width(1.0),                     // Default line width
-      plot_style(plot_style_t::lines),     // Default plot style is lines
-      smooth_style(smooth_style_t::none),  // No smoothing by default
-      line_style(""),                      // No custom line style
-      line_color(""),                      // Default line color is unspecified
-      point_style(point_style_t::none),    // Default point style is none
-      point_size(-1.0)                     // Default point size is unspecified
+/// Access mode needed to create files inside a directory: write permission,
+/// plus search permission on UNIX-like systems, where _access() modes do not apply.
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__TOS_WIN__)
+#define GP_DIRECTORY_ACCESS 2
+#elif defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+#define GP_DIRECTORY_ACCESS 3
+#endif
+
+/// @brief Size of the buffer used to serialize records before writing them.
+#define GP_WRITE_BUFFER_SIZE (1 << 20)
+
+/// @brief Number of full buffers gathered by a single vectored write.
+#define GP_WRITE_VECTOR_SIZE 8
+
+/// @brief Number of points of the smallest blocks of a pyramid, a power of two.
+#define GP_PYRAMID_STRIDE 8
+
+/// @brief Default number of pixel columns, or of points, of the decimation, the width of a large screen.
+#define GP_DECIMATION_SIZE 2048
+
+/// @brief Code marking non-finite values in quantized data.
+#define GP_QUANTIZED_INVALID 65535
+
+/// @brief Time given to Gnuplot to open the named pipes of a plot command for reading, or to write the
+/// marker settling the temporary files when the quota needs room, in milliseconds.
+#define GP_FIFO_TIMEOUT_MS 5000
 
+namespace detail
 {
-#if (defined(unix) || defined(__unix) || defined(__unix__)) && !defined(__APPLE__)
-    // Ensure DISPLAY is set for Unix systems.
-    if (!getenv("DISPLAY")) {
-        std::cerr << "Error: DISPLAY variable not set.\n";
-        valid = false;
-        return;
-    }
-#endif
 
-    // Check if gnuplot is available.
-    if (!Gnuplot::get_program_path()) {
-        std::cerr << "Error: Gnuplot executable not found.\n";
-        valid = false;
-        return;
+/// @brief The type of the elements stored inside a container.
+template <typename Container>
+using column_value_t = typename std::decay<decltype(std::declval<const Container &>()[0])>::type;
+
+/// @brief Gives the type used to store a value in binary mode, and its Gnuplot format specifier.
+/// @details Floating point and integral values keep their native type, anything
+/// else is converted to a double.
+template <typename T, typename Enable = void>
+struct binary_traits {
+    using type = double;
+    static const char *format()
+    {
+        return "%double";
     }
+};
 
-    // Try to open a pipe to Gnuplot.
-    gnuplot_pipe = OPEN_PIPE((Gnuplot::m_gnuplot_path + "/" + Gnuplot::m_gnuplot_filename).c_str(), "w");
-    if (!gnuplot_pipe) {
-        std::cerr << "Error: Unable to open pipe to Gnuplot.\n";
-        valid = false;
-        return;
+template <>
+struct binary_traits<float> {
+    using type = float;
+    static const char *format()
+    {
+        return "%float";
     }
+};
 
-    // Initialize plotting state.
-    valid   = true;
-    nplots  = 0;
-    two_dim = false;
+template <typename T>
+struct binary_traits<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+    using type = T;
+    static const char *format()
+    {
+        static const char *const formats[2][4] = {
+            { "%uint8", "%uint16", "%uint32", "%uint64" },
+            { "%int8", "%int16", "%int32", "%int64" },
+        };
+        return formats[std::is_signed<T>::value][(sizeof(T) == 1) ? 0 : (sizeof(T) == 2) ? 1 : (sizeof(T) == 4) ? 2 : 3];
+    }
+};
 
-    // Initialize styles.
-    plot_style   = plot_style_t::none;
-    smooth_style = smooth_style_t::none;
-    line_style.clear();
-    line_color.clear();
-    point_style = point_style_t::plus;
-    point_size  = -1.0;
-    line_width  = -1.0;
+/// @brief Whether values are written with their stream operator, which prints
+/// characters as such and booleans as 0 or 1, instead of being formatted as numbers.
+template <typename T>
+struct is_streamed : std::integral_constant<bool,
+                                            !std::is_arithmetic<T>::value || std::is_same<T, bool>::value ||
+                                                std::is_same<T, char>::value ||
+                                                std::is_same<T, signed char>::value ||
+                                                std::is_same<T, unsigned char>::value> {
+};
 
-    // Initialize contour settings.
-    contour.type  = contour_type_t::none;
-    contour.param = contour_param_t::levels;
-    contour.discrete_levels.clear();
-    contour.increment_start = 0.0;
-    contour.increment_step  = 0.1;
-    contour.increment_end   = 1.0;
-    contour.levels          = 10;
+/// @brief Whether the values of every column are arithmetic, which binary formats require.
+/// @details Columns of any other type are written as text instead.
+template <typename... Columns>
+struct all_arithmetic : std::true_type {
+};
 
-    // Clear temporary file list.
-    tmpfile_list.clear();
+template <typename Column, typename... Columns>
+struct all_arithmetic<Column, Columns...>
+    : std::integral_constant<bool,
+                             std::is_arithmetic<column_value_t<Column>>::value && all_arithmetic<Columns...>::value> {
+};
 
-    // Set terminal type and initial plot settings.
-    this->showonscreen();
+#if defined(__cpp_lib_to_chars)
+/// @brief Appends the text of a floating point value to the buffer.
+/// @param precision The number of significant digits, negative for the shortest round-trip form.
+template <typename T>
+static inline typename std::enable_if<std::is_floating_point<T>::value>::type
+append_value(std::string &buffer, T value, int precision)
+{
+    char text[64];
+    const std::to_chars_result result = (precision < 0)
+                                            ? std::to_chars(text, text + sizeof(text), value)
+                                            : std::to_chars(text, text + sizeof(text), value,
+                                                            std::chars_format::general, precision);
+    buffer.append(text, result.ptr);
 }
 
-Gnuplot::~Gnuplot()
+/// @brief Appends the text of an integral value to the buffer.
+template <typename T>
+static inline typename std::enable_if<std::is_integral<T>::value && !is_streamed<T>::value>::type
+append_value(std::string &buffer, T value, int)
 {
-    // Close the communication pipe to Gnuplot if it's open
-    if (gnuplot_pipe) {
-        if (CLOSE_PIPE(gnuplot_pipe) == -1) {
-            std::cerr << "Warning: Problem closing communication to Gnuplot.\n";
-        }
-        // Avoid dangling pointer.
-        gnuplot_pipe = nullptr;
-    }
-
-    // Remove all temporary files created during the session
-    remove_tmpfiles();
+    char text[32];
+    const std::to_chars_result result = std::to_chars(text, text + sizeof(text), value);
+    buffer.append(text, result.ptr);
 }
-
-Gnuplot &Gnuplot::send_cmd(const std::string &cmdstr)
+#else
+/// @brief Prints a floating point value with the given number of significant digits.
+static inline int print_real(char *text, std::size_t size, int precision, double value)
 {
-    // Check if the Gnuplot session is ready.
-    if (!this->is_ready()) {
-        std::cerr << "Error: Invalid Gnuplot session not ready.\n";
-        return *this;
-    }
+    return snprintf(text, size, "%.*g", precision, value);
+}
 
-    // Write the command to the Gnuplot pipe.
-    fprintf(gnuplot_pipe, "%s\n", cmdstr.c_str());
-    fflush(gnuplot_pipe);
+static inline int print_real(char *text, std::size_t size, int precision, long double value)
+{
+    return snprintf(text, size, "%.*Lg", precision, value);
+}
 
-    // Check and update state based on the command type.
-    if (cmdstr.find("replot") != std::string::npos) {
-        // Do not increment plot count or change dimensionality.
-    }
-    // Command starts with "splot".
-    else if (cmdstr.find("splot") == 0) {
-        two_dim = false;
-        nplots++;
-    }
-    // Command starts with "plot".
-    else if (cmdstr.find("plot") == 0) {
-        two_dim = true;
-        nplots++;
+/// @brief Appends the text of an arithmetic value to the buffer.
+/// @details Fallback for compilers without std::to_chars, the decimal separator
+/// of the C locale is replaced so that the output does not depend on it.
+template <typename T>
+static inline typename std::enable_if<std::is_arithmetic<T>::value && !is_streamed<T>::value>::type
+append_value(std::string &buffer, T value, int precision)
+{
+    using real_t = typename std::conditional<std::is_same<T, long double>::value, long double, double>::type;
+    char text[64];
+    int length;
+    if (std::is_integral<T>::value) {
+        length = std::is_signed<T>::value ? snprintf(text, sizeof(text), "%lld", static_cast<long long>(value))
+                                          : snprintf(text, sizeof(text), "%llu", static_cast<unsigned long long>(value));
+    } else {
+        length = print_real(text, sizeof(text), (precision < 0) ? std::numeric_limits<T>::max_digits10 : precision,
+                            static_cast<real_t>(value));
+        const char separator = localeconv()->decimal_point[0];
+        for (int i = 0; (separator != '.') && (i < length); ++i) {
+            if (text[i] == separator) {
+                text[i] = '.';
+            }
+        }
     }
-
-    return *this;
+    buffer.append(text, static_cast<std::size_t>(length));
 }
+#endif
 
-template <typename X>
-Gnuplot &Gnuplot::plot_x(const X &x, const std::string &title)
+/// @brief Appends the text of any other value to the buffer, using its stream operator.
+template <typename T>
+static inline typename std::enable_if<is_streamed<T>::value>::type
+append_value(std::string &buffer, const T &value, int precision)
 {
-    // Check if the Gnuplot session is ready.
-    if (!this->is_ready()) {
-        std::cerr << "Error: Invalid Gnuplot session not ready.\n";
-        return *this;
+    std::ostringstream oss;
+    oss.imbue(std::locale::classic());
+    if (precision >= 0) {
+        oss.precision(precision);
     }
+    oss << value;
+    buffer += oss.str();
+}
 
-    // Check if the input vector is empty.
-    if (x.empty()) {
-        std::cerr << "Error: Input vector is empty. Cannot plot data." << std::endl;
-        return *this;
-    }
+/// @brief Terminates the recursion of write_text_row.
+static inline void write_text_row(std::string &, int, std::size_t)
+{
+}
 
-    // Create a temporary file for storing the data
-    std::ofstream file;
-    std::string filename = this->create_tmpfile(file);
-    if (filename.empty()) {
-        std::cerr << "Error: Temporary file filename is empty. File creation failed." << std::endl;
-        return *this;
-    }
+/// @brief Appends the value at the given row of each column to the buffer, as a line of text.
+template <typename Column, typename... Columns>
+static inline void
+write_text_row(std::string &buffer, int precision, std::size_t row, const Column &column, const Columns &...columns)
+{
+    append_value(buffer, static_cast<column_value_t<Column>>(column[row]), precision);
+    buffer.push_back((sizeof...(Columns) > 0) ? ' ' : '\n');
+    write_text_row(buffer, precision, row, columns...);
+}
 
-    // Write the data to the temporary file
-    for (size_t i = 0; i < x.size(); ++i) {
-        if (!(file << x[i] << '\n')) {
-            file.close();
-            std::cerr << "Error: Failed to write data to the temporary file: " << filename << std::endl;
-            return *this;
+/// @brief Writes the whole buffer to the given descriptor, retrying after partial writes.
+/// @return `true` on success, `false` otherwise.
+static inline bool write_all(int fd, const char *data, std::size_t size)
+{
+    while (size > 0) {
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__TOS_WIN__)
+        const int written = _write(fd, data, static_cast<unsigned int>(std::min<std::size_t>(size, 1u << 30)));
+#else
+        const ssize_t written = write(fd, data, size);
+#endif
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
         }
+        data += written;
+        size -= static_cast<std::size_t>(written);
     }
+    return true;
+}
 
-    // Ensure the file buffer is flushed
-    file.flush();
-    if (file.fail()) {
-        file.close();
-        std::cerr << "Error: Failed to flush data to the temporary file: " << filename << std::endl;
-        return *this;
-    }
-    file.close();
-
-    // Check if the file is available for reading.
-    if (!this->file_ready(filename)) {
-        std::cerr << "Error: File " << filename << " is not available for reading." << std::endl;
-        return *this;
+/// @brief Writes the whole buffer at the given offset of the descriptor, without moving its position.
+/// @return `true` on success, `false` otherwise.
+static inline bool write_at(int fd, const char *data, std::size_t size, std::size_t offset)
+{
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    while (size > 0) {
+        const ssize_t written = pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+        offset += static_cast<std::size_t>(written);
     }
+    return true;
+#else
+    return (_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) != -1) && write_all(fd, data, size);
+#endif
+}
 
-    std::ostringstream oss;
-    // Determine whether to use 'plot' or 'replot' based on the current plot state.
-    oss << ((nplots > 0 && two_dim) ? "replot" : "plot");
-    // Specify the file and columns for the Gnuplot command.
-    oss << " \"" << filename << "\" using 1";
-    // Add a title or specify 'notitle' if no title is provided.
-    oss << (title.empty() ? " notitle " : " title \"" + title + "\"");
-    // Specify the plot style or smoothing option.
-    if (smooth_style == smooth_style_t::none) {
-        oss << " with " << this->plot_style_to_string(plot_style);
-    } else {
-        oss << " smooth " << this->smooth_style_to_string(smooth_style);
-    }
-    // Include line color if it is specified.
-    if (!line_color.empty()) {
-        oss << " lc rgb \"" << line_color << "\"";
+/// @brief Writes all the buffers to the given descriptor, with as few system calls as possible.
+/// @return `true` on success, `false` otherwise.
+static inline bool write_vectored(int fd, const std::vector<std::string> &chunks)
+{
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    std::vector<struct iovec> vectors;
+    vectors.reserve(chunks.size());
+    for (const std::string &chunk : chunks) {
+        if (!chunk.empty()) {
+            vectors.push_back({ const_cast<char *>(chunk.data()), chunk.size() });
+        }
     }
-    // Add line style options only if the plot style supports lines.
-    if (is_line_style(plot_style)) {
-        // Add line width if specified.
-        if (line_width > 0) {
-            oss << " lw " << line_width;
+    // Resume from the first vector which was not entirely written.
+    std::size_t first = 0;
+    while (first < vectors.size()) {
+        const ssize_t written = writev(fd, &vectors[first], static_cast<int>(vectors.size() - first));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
         }
-        // Add line style if specified.
-        if (!line_style.empty()) {
-            oss << " " << line_style;
+        std::size_t left = static_cast<std::size_t>(written);
+        for (; (first < vectors.size()) && (left >= vectors[first].iov_len); ++first) {
+            left -= vectors[first].iov_len;
+        }
+        if (first < vectors.size()) {
+            vectors[first].iov_base = static_cast<char *>(vectors[first].iov_base) + left;
+            vectors[first].iov_len -= left;
         }
     }
-    // Add point style and size only if the plot style supports points.
-    if (is_point_style(plot_style)) {
-        // Add point style if specified.
-        oss << " pt " << this->point_style_to_string(point_style);
-        // Add point size if specified.
-        if (point_size > 0) {
-            oss << " ps " << point_size;
+    return true;
+#else
+    for (const std::string &chunk : chunks) {
+        if (!write_all(fd, chunk.data(), chunk.size())) {
+            return false;
         }
     }
-    // Send the constructed command to Gnuplot for execution
-    this->send_cmd(oss.str());
-
-    return *this;
+    return true;
+#endif
 }
 
-template <typename X>
-Gnuplot &Gnuplot::plot_x(const std::vector<X> &datasets, const std::vector<std::string> &titles)
-{
-    // Check if the Gnuplot session is ready
-    if (!this->is_ready()) {
-        std::cerr << "Error: Invalid Gnuplot session not ready.\n";
-        return *this;
-    }
+/// @brief Parameters mapping the values of a column to 16-bit integers.
+/// @details Finite values are mapped on `[0, GP_QUANTIZED_INVALID)`, while
+/// GP_QUANTIZED_INVALID itself marks non-finite values.
+struct quantization_t {
+    double offset = 0.0;  ///< The value mapped to 0.
+    double scale  = 1.0;  ///< The difference between two consecutive codes.
+    bool invalid  = false; ///< Whether some values are not finite.
+};
 
-    // Validate input data
-    if (datasets.empty()) {
-        std::cerr << "Error: Input datasets are empty. Cannot plot.\n";
-        return *this;
-    }
+/// @brief Instruction sets used by the kernels scanning arrays of values.
+enum class simd_t {
+    scalar, ///< Plain loops.
+    sse2,   ///< 128-bit vectors, available on every x86-64 processor.
+    avx2,   ///< 256-bit vectors, detected at run time.
+};
 
-    if (!titles.empty() && titles.size() != datasets.size()) {
-        std::cerr << "Error: Mismatch between the number of datasets and titles.\n";
-        return *this;
-    }
+/// @brief Gives the widest instruction set supported by both the build and the processor.
+static inline simd_t simd_support()
+{
+#if defined(GP_USE_AVX2) && (defined(__GNUC__) || defined(__clang__))
+    static const simd_t support = __builtin_cpu_supports("avx2") ? simd_t::avx2 : simd_t::sse2;
+    return support;
+#elif defined(GP_USE_AVX2)
+    return simd_t::avx2;
+#elif defined(GP_USE_SIMD)
+    return simd_t::sse2;
+#else
+    return simd_t::scalar;
+#endif
+}
 
-    std::vector<std::string> filenames;
-    filenames.reserve(datasets.size());
+/// @brief Whether a container stores its double or float values contiguously, which the kernels require.
+template <typename Column, typename Enable = void>
+struct contiguous_t : std::false_type {
+};
 
-    // Create temporary files for each dataset
-    for (size_t i = 0; i < datasets.size(); ++i) {
-        if (datasets[i].empty()) {
-            std::cerr << "Error: Dataset " << i + 1 << " is empty. Skipping.\n";
-            continue;
-        }
+template <typename Column>
+struct contiguous_t<
+    Column,
+    typename std::enable_if<(std::is_same<column_value_t<Column>, double>::value ||
+                             std::is_same<column_value_t<Column>, float>::value) &&
+                            std::is_same<decltype(std::declval<const Column &>().data()),
+                                         const column_value_t<Column> *>::value>::type> : std::true_type {
+};
 
-        std::ofstream file;
-        std::string filename = this->create_tmpfile(file);
-        if (filename.empty()) {
-            std::cerr << "Error: Temporary file creation failed for dataset " << i + 1 << ". Skipping.\n";
+/// @brief Extends the range [min, max] with the finite values of an array or a container.
+/// @return The number of non-finite values.
+template <typename Data>
+static inline std::size_t
+scan_range_scalar(const Data &data, std::size_t begin, std::size_t end, double &min, double &max)
+{
+    std::size_t nonfinite = 0;
+    for (std::size_t i = begin; i < end; ++i) {
+        const double value = static_cast<double>(data[i]);
+        if (!std::isfinite(value)) {
+            nonfinite++;
             continue;
         }
-
-        for (const auto &value : datasets[i]) {
-            if (!(file << value << '\n')) {
-                std::cerr << "Error: Failed to write data to temporary file: " << filename << ". Skipping dataset.\n";
-                file.close();
-                continue;
-            }
+        if (value < min) {
+            min = value;
+        }
+        if (value > max) {
+            max = value;
         }
+    }
+    return nonfinite;
+}
 
-        file.flush();
-        if (file.fail()) {
-            std::cerr << "Error: Failed to flush data to temporary file: " << filename << ". Skipping dataset.\n";
-            file.close();
+/// @brief Finds the first lowest and the first highest finite values of an array or a container.
+/// @param lowest Receives the index of the lowest value, `end` if none is finite.
+/// @param highest Receives the index of the highest value, `end` if none is finite.
+/// @return The number of non-finite values.
+template <typename Data>
+static inline std::size_t
+find_extrema_scalar(const Data &data, std::size_t begin, std::size_t end, std::size_t &lowest, std::size_t &highest)
+{
+    std::size_t nonfinite = 0;
+    lowest = highest = end;
+    for (std::size_t i = begin; i < end; ++i) {
+        const double value = static_cast<double>(data[i]);
+        if (!std::isfinite(value)) {
+            nonfinite++;
             continue;
         }
-        file.close();
+        if ((lowest == end) || (value < static_cast<double>(data[lowest]))) {
+            lowest = i;
+        }
+        if ((highest == end) || (value > static_cast<double>(data[highest]))) {
+            highest = i;
+        }
+    }
+    return nonfinite;
+}
 
-        filenames.push_back(filename);
+/// @brief Counts the finite values of an array or a container outside of [lower, upper].
+template <typename Data>
+static inline std::size_t
+count_outside_scalar(const Data &data, std::size_t begin, std::size_t end, double lower, double upper)
+{
+    std::size_t outside = 0;
+    for (std::size_t i = begin; i < end; ++i) {
+        const double value = static_cast<double>(data[i]);
+        if (std::isfinite(value) && ((value < lower) || (value > upper))) {
+            outside++;
+        }
     }
+    return outside;
+}
 
-    if (filenames.empty()) {
-        std::cerr << "Error: No valid datasets to plot.\n";
-        return *this;
-    }
-
-    // Check if the file is available for reading.
-    for (size_t i = 0; i < filenames.size(); ++i) {
-        if (!this->file_ready(filenames[i])) {
-            std::cerr << "Error: File " << filenames[i] << " is not available for reading.\n";
-            return *this;
-        }
+/// @brief Counts the bits set in the mask of a vector comparison.
+static inline std::size_t count_lanes(int mask)
+{
+    std::size_t count = 0;
+    for (; mask != 0; mask &= mask - 1) {
+        count++;
     }
+    return count;
+}
 
-    std::ostringstream oss;
-
-    // Determine the command ('plot' or 'replot')
-    oss << ((nplots > 0 && two_dim) ? "replot " : "plot ");
-
-    // Construct the plotting command for each dataset
-    for (size_t i = 0; i < filenames.size(); ++i) {
-        oss << "\"" << filenames[i] << "\" using 1";
-
-        // Add title
-        if (titles.empty() || titles[i].empty()) {
-            oss << " notitle ";
-        } else {
-            oss << " title \"" << titles[i] << "\" ";
-        }
-
-        // Specify plot style or smoothing
-        if (smooth_style == smooth_style_t::none) {
-            oss << " with " << this->plot_style_to_string(plot_style);
-        } else {
-            oss << " smooth " << this->smooth_style_to_string(smooth_style);
-        }
-
-        // Add line options if applicable
-        if (is_line_style(plot_style)) {
-            if (line_width > 0) {
-                oss << " lw " << line_width;
-            }
-            if (!line_color.empty()) {
-                oss << " lc rgb \"" << line_color << "\"";
+/// @brief Merges the extremes kept by each vector lane with those of the values left after the last vector.
+/// @param scanned The number of values scanned by the vectors.
+/// @param lanes The number of lanes.
+/// @return The number of non-finite values left after the last vector.
+template <typename T>
+static inline std::size_t merge_extrema(const T *data,
+                                        std::size_t size,
+                                        std::size_t scanned,
+                                        int lanes,
+                                        const double *lows,
+                                        const double *low_indices,
+                                        const double *highs,
+                                        const double *high_indices,
+                                        std::size_t &lowest,
+                                        std::size_t &highest)
+{
+    const std::size_t nonfinite = find_extrema_scalar(data, scanned, size, lowest, highest);
+    // Lanes without finite values kept the index -1, ties go to the first value.
+    for (int k = 0; k < lanes; ++k) {
+        if (low_indices[k] >= 0.0) {
+            const std::size_t index = static_cast<std::size_t>(low_indices[k]);
+            const double value      = (lowest == size) ? 0.0 : static_cast<double>(data[lowest]);
+            if ((lowest == size) || (lows[k] < value) || ((lows[k] == value) && (index < lowest))) {
+                lowest = index;
             }
         }
-
-        // Add point options if applicable
-        if (is_point_style(plot_style)) {
-            oss << " pt " << this->point_style_to_string(point_style);
-            if (point_size > 0) {
-                oss << " ps " << point_size;
+        if (high_indices[k] >= 0.0) {
+            const std::size_t index = static_cast<std::size_t>(high_indices[k]);
+            const double value      = (highest == size) ? 0.0 : static_cast<double>(data[highest]);
+            if ((highest == size) || (highs[k] > value) || ((highs[k] == value) && (index < highest))) {
+                highest = index;
             }
         }
-
-        // Add a comma unless it's the last dataset
-        if (i != filenames.size() - 1) {
-            oss << ", ";
-        }
     }
+    return nonfinite;
+}
 
-    // Send the constructed command to Gnuplot
-    this->send_cmd(oss.str());
-
-    return *this;
+#if defined(GP_USE_SIMD)
+/// @brief Loads two values as doubles.
+static inline __m128d load_sse2(const double *data)
+{
+    return _mm_loadu_pd(data);
 }
 
-template <typename X, typename Y>
-Gnuplot &Gnuplot::plot_xy(const X &x, const Y &y, const std::string &title)
+static inline __m128d load_sse2(const float *data)
 {
-    // Check if the Gnuplot session is ready
-    if (!this->is_ready()) {
-        std::cerr << "Error: Invalid Gnuplot session. Cannot plot.\n";
-        return *this;
-    }
+    return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(data))));
+}
 
-    // Validate input vectors
-    if (x.empty() || y.empty()) {
-        std::cerr << "Error: Input vectors are empty. Cannot plot.\n";
-        return *this;
-    }
+/// @brief Selects the lanes of `a` where the mask is set, and those of `b` elsewhere.
+static inline __m128d select_sse2(__m128d mask, __m128d a, __m128d b)
+{
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
 
-    if (x.size() != y.size()) {
-        std::cerr << "Error: Mismatch between the lengths of x and y vectors.\n";
-        return *this;
+template <typename T>
+static inline std::size_t scan_range_sse2(const T *data, std::size_t size, double &min, double &max)
+{
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d up   = _mm_set1_pd(std::numeric_limits<double>::infinity());
+    const __m128d down = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+    __m128d low = up, high = down;
+    std::size_t nonfinite = 0, i = 0;
+    for (; i + 2 <= size; i += 2) {
+        const __m128d value = load_sse2(data + i);
+        // Infinities and NaN give NaN once subtracted from themselves.
+        const __m128d finite = _mm_cmpeq_pd(_mm_sub_pd(value, value), zero);
+        low                  = _mm_min_pd(low, select_sse2(finite, value, up));
+        high                 = _mm_max_pd(high, select_sse2(finite, value, down));
+        nonfinite += 2 - count_lanes(_mm_movemask_pd(finite));
     }
-
-    // Create a temporary file for storing the data
-    std::ofstream file;
-    std::string filename = this->create_tmpfile(file);
-    if (filename.empty()) {
-        std::cerr << "Error: Failed to create a temporary file.\n";
-        return *this;
+    double lows[2], highs[2];
+    _mm_storeu_pd(lows, low);
+    _mm_storeu_pd(highs, high);
+    for (int k = 0; k < 2; ++k) {
+        min = std::min(min, lows[k]);
+        max = std::max(max, highs[k]);
     }
+    return nonfinite + scan_range_scalar(data, i, size, min, max);
+}
 
-    // Write the data to the temporary file
-    for (size_t i = 0; i < x.size(); ++i) {
-        if (!(file << x[i] << " " << y[i] << '\n')) {
-            std::cerr << "Error: Failed to write data to the temporary file: " << filename << '\n';
-            file.close();
-            return *this;
-        }
+template <typename T>
+static inline std::size_t find_extrema_sse2(const T *data, std::size_t size, std::size_t &lowest, std::size_t &highest)
+{
+    const __m128d zero = _mm_setzero_pd(), step = _mm_set1_pd(2.0);
+    __m128d low  = _mm_set1_pd(std::numeric_limits<double>::infinity());
+    __m128d high = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+    __m128d low_index = _mm_set1_pd(-1.0), high_index = _mm_set1_pd(-1.0), index = _mm_set_pd(1.0, 0.0);
+    std::size_t nonfinite = 0, i = 0;
+    for (; i + 2 <= size; i += 2) {
+        const __m128d value  = load_sse2(data + i);
+        const __m128d finite = _mm_cmpeq_pd(_mm_sub_pd(value, value), zero);
+        // Each lane keeps its first extremes, strict comparisons skip ties.
+        const __m128d lower  = _mm_and_pd(finite, _mm_cmplt_pd(value, low));
+        const __m128d higher = _mm_and_pd(finite, _mm_cmpgt_pd(value, high));
+        low                  = select_sse2(lower, value, low);
+        low_index            = select_sse2(lower, index, low_index);
+        high                 = select_sse2(higher, value, high);
+        high_index           = select_sse2(higher, index, high_index);
+        index                = _mm_add_pd(index, step);
+        nonfinite += 2 - count_lanes(_mm_movemask_pd(finite));
     }
+    double lows[2], highs[2], low_indices[2], high_indices[2];
+    _mm_storeu_pd(lows, low);
+    _mm_storeu_pd(highs, high);
+    _mm_storeu_pd(low_indices, low_index);
+    _mm_storeu_pd(high_indices, high_index);
+    return nonfinite + merge_extrema(data, size, i, 2, lows, low_indices, highs, high_indices, lowest, highest);
+}
 
-    // Flush the file buffer and close the file
-    file.flush();
-    if (file.fail()) {
-        std::cerr << "Error: Failed to flush data to the temporary file: " << filename << '\n';
-        file.close();
-        return *this;
+template <typename T>
+static inline std::size_t count_outside_sse2(const T *data, std::size_t size, double lower, double upper)
+{
+    const __m128d zero = _mm_setzero_pd(), low = _mm_set1_pd(lower), high = _mm_set1_pd(upper);
+    std::size_t outside = 0, i = 0;
+    for (; i + 2 <= size; i += 2) {
+        const __m128d value  = load_sse2(data + i);
+        const __m128d finite = _mm_cmpeq_pd(_mm_sub_pd(value, value), zero);
+        const __m128d out    = _mm_or_pd(_mm_cmplt_pd(value, low), _mm_cmpgt_pd(value, high));
+        outside += count_lanes(_mm_movemask_pd(_mm_and_pd(finite, out)));
     }
-    file.close();
+    return outside + count_outside_scalar(data, i, size, lower, upper);
+}
+#endif
 
-    // Check if the file is available for reading
-    if (!this->file_ready(filename)) {
-        std::cerr << "Error: File " << filename << " is not available for reading.\n";
-        return *this;
-    }
-    std::ostringstream oss;
-    // Determine whether to use 'plot' or 'replot' based on the current plot state
-    oss << ((nplots > 0 && two_dim) ? "replot" : "plot");
-    // Specify the file and columns for the Gnuplot command
-    oss << " \"" << filename << "\" using 1:2";
-    // Add a title or specify 'notitle' if no title is provided
-    oss << (title.empty() ? " notitle " : " title \"" + title + "\"");
-    // Specify the plot style or smoothing option.
-    if (smooth_style == smooth_style_t::none) {
-        oss << " with " << this->plot_style_to_string(plot_style);
-    } else {
-        oss << " smooth " << this->smooth_style_to_string(smooth_style);
-    }
-    // Include line color if it is specified.
-    if (!line_color.empty()) {
-        oss << " lc rgb \"" << line_color << "\"";
-    }
-    // Add line style options only if the plot style supports lines.
-    if (is_line_style(plot_style)) {
-        // Add line width if specified.
-        if (line_width > 0) {
-            oss << " lw " << line_width;
-        }
-        // Add line style if specified.
-        if (!line_style.empty()) {
-            oss << " " << line_style;
-        }
-    }
-    // Add point style and size only if the plot style supports points.
-    if (is_point_style(plot_style)) {
-        // Add point style if specified.
-        oss << " pt " << this->point_style_to_string(point_style);
-        // Add point size if specified.
-        if (point_size > 0) {
-            oss << " ps " << point_size;
-        }
-    }
-    // Send the constructed command to Gnuplot for execution
-    this->send_cmd(oss.str());
+#if defined(GP_USE_AVX2)
+/// @brief Loads four values as doubles.
+GP_TARGET_AVX2 static inline __m256d load_avx2(const double *data)
+{
+    return _mm256_loadu_pd(data);
+}
 
-    return *this;
+GP_TARGET_AVX2 static inline __m256d load_avx2(const float *data)
+{
+    return _mm256_cvtps_pd(_mm_loadu_ps(data));
 }
 
-template <typename X, typename Y, typename E>
-Gnuplot &
-Gnuplot::plot_xy_erorrbar(const X &x, const Y &y, const E &dy, erorrbar_style_t style, const std::string &title)
+template <typename T>
+GP_TARGET_AVX2 static inline std::size_t scan_range_avx2(const T *data, std::size_t size, double &min, double &max)
 {
-    // Check if the Gnuplot session is ready
-    if (!this->is_ready()) {
-        std::cerr << "Error: Invalid Gnuplot session. Cannot plot.\n";
-        return *this;
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d up   = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    const __m256d down = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+    __m256d low = up, high = down;
+    std::size_t nonfinite = 0, i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const __m256d value = load_avx2(data + i);
+        // Infinities and NaN give NaN once subtracted from themselves.
+        const __m256d finite = _mm256_cmp_pd(_mm256_sub_pd(value, value), zero, _CMP_EQ_OQ);
+        low                  = _mm256_min_pd(low, _mm256_blendv_pd(up, value, finite));
+        high                 = _mm256_max_pd(high, _mm256_blendv_pd(down, value, finite));
+        nonfinite += 4 - count_lanes(_mm256_movemask_pd(finite));
     }
-
-    // Validate input vectors
-    if (x.empty() || y.empty() || dy.empty()) {
-        std::cerr << "Error: Input vectors are empty. Cannot plot.\n";
-        return *this;
+    double lows[4], highs[4];
+    _mm256_storeu_pd(lows, low);
+    _mm256_storeu_pd(highs, high);
+    for (int k = 0; k < 4; ++k) {
+        min = std::min(min, lows[k]);
+        max = std::max(max, highs[k]);
     }
+    return nonfinite + scan_range_scalar(data, i, size, min, max);
+}
 
-    if (x.size() != y.size() || x.size() != dy.size()) {
-        std::cerr << "Error: Mismatch between the lengths of x, y, and dy vectors.\n";
-        return *this;
+template <typename T>
+GP_TARGET_AVX2 static inline std::size_t
+find_extrema_avx2(const T *data, std::size_t size, std::size_t &lowest, std::size_t &highest)
+{
+    const __m256d zero = _mm256_setzero_pd(), step = _mm256_set1_pd(4.0);
+    __m256d low  = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    __m256d high = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+    __m256d low_index = _mm256_set1_pd(-1.0), high_index = _mm256_set1_pd(-1.0);
+    __m256d index     = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+    std::size_t nonfinite = 0, i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const __m256d value  = load_avx2(data + i);
+        const __m256d finite = _mm256_cmp_pd(_mm256_sub_pd(value, value), zero, _CMP_EQ_OQ);
+        // Each lane keeps its first extremes, strict comparisons skip ties.
+        const __m256d lower  = _mm256_and_pd(finite, _mm256_cmp_pd(value, low, _CMP_LT_OQ));
+        const __m256d higher = _mm256_and_pd(finite, _mm256_cmp_pd(value, high, _CMP_GT_OQ));
+        low                  = _mm256_blendv_pd(low, value, lower);
+        low_index            = _mm256_blendv_pd(low_index, index, lower);
+        high                 = _mm256_blendv_pd(high, value, higher);
+        high_index           = _mm256_blendv_pd(high_index, index, higher);
+        index                = _mm256_add_pd(index, step);
+        nonfinite += 4 - count_lanes(_mm256_movemask_pd(finite));
     }
+    double lows[4], highs[4], low_indices[4], high_indices[4];
+    _mm256_storeu_pd(lows, low);
+    _mm256_storeu_pd(highs, high);
+    _mm256_storeu_pd(low_indices, low_index);
+    _mm256_storeu_pd(high_indices, high_index);
+    return nonfinite + merge_extrema(data, size, i, 4, lows, low_indices, highs, high_indices, lowest, highest);
+}
 
-    // Create a temporary file for storing the data
-    std::ofstream file;
-    std::string filename = this->create_tmpfile(file);
-    if (filename.empty()) {
-        std::cerr << "Error: Failed to create a temporary file.\n";
-        return *this;
+template <typename T>
+GP_TARGET_AVX2 static inline std::size_t count_outside_avx2(const T *data, std::size_t size, double lower, double upper)
+{
+    const __m256d zero = _mm256_setzero_pd(), low = _mm256_set1_pd(lower), high = _mm256_set1_pd(upper);
+    std::size_t outside = 0, i = 0;
+    for (; i + 4 <= size; i += 4) {
+        const __m256d value  = load_avx2(data + i);
+        const __m256d finite = _mm256_cmp_pd(_mm256_sub_pd(value, value), zero, _CMP_EQ_OQ);
+        const __m256d out =
+            _mm256_or_pd(_mm256_cmp_pd(value, low, _CMP_LT_OQ), _mm256_cmp_pd(value, high, _CMP_GT_OQ));
+        outside += count_lanes(_mm256_movemask_pd(_mm256_and_pd(finite, out)));
     }
+    return outside + count_outside_scalar(data, i, size, lower, upper);
+}
+#endif
 
-    // Write the data to the temporary file
-    for (size_t i = 0; i < x.size(); ++i) {
-        if (!(file << x[i] << " " << y[i] << " " << dy[i] << '\n')) {
-            std::cerr << "Error: Failed to write data to the temporary file: " << filename << '\n';
-            file.close();
-            return *this;
-        }
+/// @brief Extends the range [min, max] with the finite values of an array, with the widest instruction set.
+/// @return The number of non-finite values.
+template <typename T>
+static inline std::size_t scan_range(const T *data, std::size_t size, double &min, double &max)
+{
+    switch (simd_support()) {
+#if defined(GP_USE_AVX2)
+    case simd_t::avx2:
+        return scan_range_avx2(data, size, min, max);
+#endif
+#if defined(GP_USE_SIMD)
+    case simd_t::sse2:
+        return scan_range_sse2(data, size, min, max);
+#endif
+    default:
+        return scan_range_scalar(data, 0, size, min, max);
     }
+}
 
-    // Flush the file buffer and close the file
-    file.flush();
-    if (file.fail()) {
-        std::cerr << "Error: Failed to flush data to the temporary file: " << filename << '\n';
-        file.close();
-        return *this;
+/// @brief Finds the first lowest and highest finite values of an array, with the widest instruction set.
+/// @return The number of non-finite values.
+template <typename T>
+static inline std::size_t find_extrema(const T *data, std::size_t size, std::size_t &lowest, std::size_t &highest)
+{
+    switch (simd_support()) {
+#if defined(GP_USE_AVX2)
+    case simd_t::avx2:
+        return find_extrema_avx2(data, size, lowest, highest);
+#endif
+#if defined(GP_USE_SIMD)
+    case simd_t::sse2:
+        return find_extrema_sse2(data, size, lowest, highest);
+#endif
+    default:
+        return find_extrema_scalar(data, 0, size, lowest, highest);
     }
-    file.close();
+}
 
-    // Check if the file is available for reading
-    if (!this->file_ready(filename)) {
-        std::cerr << "Error: File " << filename << " is not available for reading.\n";
-        return *this;
+/// @brief Counts the finite values of an array outside of [lower, upper], with the widest instruction set.
+template <typename T>
+static inline std::size_t count_outside(const T *data, std::size_t size, double lower, double upper)
+{
+    switch (simd_support()) {
+#if defined(GP_USE_AVX2)
+    case simd_t::avx2:
+        return count_outside_avx2(data, size, lower, upper);
+#endif
+#if defined(GP_USE_SIMD)
+    case simd_t::sse2:
+        return count_outside_sse2(data, size, lower, upper);
+#endif
+    default:
+        return count_outside_scalar(data, 0, size, lower, upper);
     }
+}
 
-    std::ostringstream oss;
-
-    // Determine whether to use 'plot' or 'replot' based on the current plot state
-    oss << ((nplots > 0 && two_dim) ? "replot " : "plot ");
+/// @brief Extends the range [min, max] with the finite values of the first rows of a column.
+/// @return The number of non-finite values.
+template <typename Column>
+static inline typename std::enable_if<contiguous_t<Column>::value, std::size_t>::type
+scan_column(const Column &column, std::size_t rows, double &min, double &max)
+{
+    return scan_range(column.data(), rows, min, max);
+}
 
-    // Specify the file and columns for the Gnuplot command
-    oss << "\"" << filename << "\" using 1:2:3 with " << this->errorbars_to_string(style) << " ";
+template <typename Column>
+static inline typename std::enable_if<!contiguous_t<Column>::value &&
+                                          std::is_arithmetic<column_value_t<Column>>::value,
+                                      std::size_t>::type
+scan_column(const Column &column, std::size_t rows, double &min, double &max)
+{
+    return scan_range_scalar(column, 0, rows, min, max);
+}
 
-    // Add a title or specify 'notitle' if no title is provided
-    oss << (title.empty() ? " notitle " : " title \"" + title + "\" ");
+template <typename Column>
+static inline typename std::enable_if<!std::is_arithmetic<column_value_t<Column>>::value, std::size_t>::type
+scan_column(const Column &, std::size_t, double &, double &)
+{
+    return 0;
+}
 
-    // Include line color if it is specified.
-    if (!line_color.empty()) {
-        oss << " lc rgb \"" << line_color << "\"";
-    }
+/// @brief Finds the first lowest and highest finite values of the rows [begin, end) of a column.
+/// @return The number of non-finite values.
+template <typename Column>
+static inline typename std::enable_if<contiguous_t<Column>::value, std::size_t>::type column_extrema(
+    const Column &column, std::size_t begin, std::size_t end, std::size_t &lowest, std::size_t &highest)
+{
+    const std::size_t nonfinite = find_extrema(column.data() + begin, end - begin, lowest, highest);
+    lowest += begin;
+    highest += begin;
+    return nonfinite;
+}
 
-    // Add line width if specified.
-    if (line_width > 0) {
-        oss << " lw " << line_width;
-    }
-    // Add line style if specified.
-    if (!line_style.empty()) {
-        oss << " " << line_style;
-    }
+template <typename Column>
+static inline typename std::enable_if<!contiguous_t<Column>::value, std::size_t>::type column_extrema(
+    const Column &column, std::size_t begin, std::size_t end, std::size_t &lowest, std::size_t &highest)
+{
+    return find_extrema_scalar(column, begin, end, lowest, highest);
+}
 
-    // Add point style if specified.
-    oss << " pt " << this->point_style_to_string(point_style);
-    // Add point size if specified.
-    if (point_size > 0) {
-        oss << " ps " << point_size;
-    }
+/// @brief Counts the non-finite values of the first rows of a column, none for non-arithmetic columns.
+template <typename Column>
+static inline typename std::enable_if<std::is_arithmetic<column_value_t<Column>>::value, std::size_t>::type
+column_nonfinite(const Column &column, std::size_t rows)
+{
+    double min = std::numeric_limits<double>::infinity(), max = -std::numeric_limits<double>::infinity();
+    return scan_column(column, rows, min, max);
+}
 
-    // Send the constructed command to Gnuplot for execution
-    this->send_cmd(oss.str());
+template <typename Column>
+static inline typename std::enable_if<!std::is_arithmetic<column_value_t<Column>>::value, std::size_t>::type
+column_nonfinite(const Column &, std::size_t)
+{
+    return 0;
+}
 
-    return *this;
+/// @brief Counts the finite values of the first rows of a column outside of [lower, upper], none for
+/// non-arithmetic columns.
+template <typename Column>
+static inline typename std::enable_if<contiguous_t<Column>::value, std::size_t>::type
+column_outside(const Column &column, std::size_t rows, double lower, double upper)
+{
+    return count_outside(column.data(), rows, lower, upper);
 }
 
-template <typename X, typename Y, typename Z>
-Gnuplot &Gnuplot::plot_xyz(const X &x, const Y &y, const Z &z, const std::string &title)
+template <typename Column>
+static inline typename std::enable_if<!contiguous_t<Column>::value &&
+                                          std::is_arithmetic<column_value_t<Column>>::value,
+                                      std::size_t>::type
+column_outside(const Column &column, std::size_t rows, double lower, double upper)
 {
-    // Check if the Gnuplot session is ready
-    if (!this->is_ready()) {
-        std::cerr << "Error: Invalid Gnuplot session. Cannot plot.\n";
-        return *this;
-    }
+    return count_outside_scalar(column, 0, rows, lower, upper);
+}
 
-    // Validate input vectors
-    if (x.empty() || y.empty() || z.empty()) {
-        std::cerr << "Error: Input vectors are empty. Cannot plot.\n";
-        return *this;
-    }
+template <typename Column>
+static inline typename std::enable_if<!std::is_arithmetic<column_value_t<Column>>::value, std::size_t>::type
+column_outside(const Column &, std::size_t, double, double)
+{
+    return 0;
+}
 
-    if (x.size() != y.size() || x.size() != z.size()) {
-        std::cerr << "Error: Mismatch between the lengths of x, y, and z vectors.\n";
-        return *this;
-    }
+/// @brief Extends the range [min, max] with the finite values of a column.
+/// @return `true` if all the values are finite, `false` otherwise.
+template <typename Column>
+static inline bool extend_range(const Column &column, std::size_t rows, double &min, double &max)
+{
+    return scan_column(column, rows, min, max) == 0;
+}
 
-    // Create a temporary file for storing the data
-    std::ofstream file;
-    std::string filename = this->create_tmpfile(file);
-    if (filename.empty()) {
-        std::cerr << "Error: Failed to create a temporary file.\n";
-        return *this;
-    }
+/// @brief Read-only view of the elements of a container at the given indices.
+template <typename Column>
+struct gather_t {
+    const Column &column;                    ///< The container.
+    const std::vector<std::size_t> &indices; ///< The indices of the viewed elements.
 
-    // Write the data to the temporary file
-    for (size_t i = 0; i < x.size(); ++i) {
-        if (!(file << x[i] << " " << y[i] << " " << z[i] << '\n')) {
-            std::cerr << "Error: Failed to write data to the temporary file: " << filename << '\n';
-            file.close();
-            return *this;
-        }
+    std::size_t size() const
+    {
+        return indices.size();
     }
 
-    // Flush the file buffer and close the file
-    file.flush();
-    if (file.fail()) {
-        std::cerr << "Error: Failed to flush data to the temporary file: " << filename << '\n';
-        file.close();
-        return *this;
+    column_value_t<Column> operator[](std::size_t i) const
+    {
+        return column[indices[i]];
     }
-    file.close();
+};
 
-    // Check if the file is available for reading
-    if (!this->file_ready(filename)) {
-        std::cerr << "Error: File " << filename << " is not available for reading.\n";
-        return *this;
-    }
+/// @brief Gives a view of the elements of a container at the given indices.
+template <typename Column>
+static inline gather_t<Column> gather(const Column &column, const std::vector<std::size_t> &indices)
+{
+    return gather_t<Column>{ column, indices };
+}
 
-    std::ostringstream oss;
+/// @brief View over rows of a series, without copying them.
+struct series_view_t {
+    const std::vector<double> &values;       ///< The values of the series.
+    const std::vector<std::size_t> &indices; ///< The viewed rows, or none for a range of rows.
+    std::size_t first;                       ///< The first viewed row, when there are no indices.
+    std::size_t rows;                        ///< The number of viewed rows.
 
-    // Determine whether to use 'splot' or 'replot' based on the current plot state
-    oss << ((nplots > 0 && !two_dim) ? "replot" : "splot");
+    std::size_t size() const
+    {
+        return rows;
+    }
 
-    // Specify the file and columns for the Gnuplot command
-    oss << " \"" << filename << "\" using 1:2:3";
+    double operator[](std::size_t i) const
+    {
+        return values[indices.empty() ? first + i : indices[i]];
+    }
+};
 
-    // Add a title or specify 'notitle' if no title is provided
-    oss << (title.empty() ? " notitle" : " title \"" + title + "\"");
+/// @brief Column holding the index of each row, the implicit x coordinate of plot_x().
+struct row_index_t {
+    std::size_t rows; ///< The number of rows.
 
-    // Specify the plot style or smoothing option.
-    if (smooth_style == smooth_style_t::none) {
-        oss << " with " << this->plot_style_to_string(plot_style);
-    } else {
-        oss << " smooth " << this->smooth_style_to_string(smooth_style);
+    std::size_t size() const
+    {
+        return rows;
     }
 
-    // Include line color if it is specified.
-    if (!line_color.empty()) {
-        oss << " lc rgb \"" << line_color << "\"";
+    std::size_t operator[](std::size_t i) const
+    {
+        return i;
     }
+};
 
-    // Add line style options only if the plot style supports lines.
-    if (is_line_style(plot_style)) {
-        // Add line width if specified.
-        if (line_width > 0) {
-            oss << " lw " << line_width;
+/// @brief Keeps the first, lowest, highest and last points of each pixel column.
+/// @details Consecutive points falling in the same column form a run, so
+/// unsorted series keep their shape, only with less reduction.
+/// @param columns The number of pixel columns spanning the x range.
+/// @param indices Receives the indices of the kept points, in increasing order.
+template <typename X, typename Y>
+static inline typename std::enable_if<
+    std::is_arithmetic<column_value_t<X>>::value && std::is_arithmetic<column_value_t<Y>>::value>::type
+decimate_minmax(const X &x, const Y &y, std::size_t columns, std::vector<std::size_t> &indices)
+{
+    const std::size_t rows = x.size();
+    double min = std::numeric_limits<double>::infinity(), max = -std::numeric_limits<double>::infinity();
+    extend_range(x, rows, min, max);
+    const double scale = (max > min) ? static_cast<double>(columns) / (max - min) : 0.0;
+
+    // Append an index, unless the run already kept it.
+    auto keep = [&indices](std::size_t index) {
+        if (indices.empty() || (indices.back() < index)) {
+            indices.push_back(index);
         }
-        // Add line style if specified.
-        if (!line_style.empty()) {
-            oss << " " << line_style;
+    };
+    // Keep the first, lowest, highest and last points of a run.
+    auto keep_run = [&keep](std::size_t first, std::size_t end, std::size_t lowest, std::size_t highest) {
+        keep(first);
+        keep(std::min(lowest, highest));
+        keep(std::max(lowest, highest));
+        keep(end - 1);
+    };
+    auto bucket = [min, scale, columns](double value) {
+        return std::min(static_cast<std::size_t>((value - min) * scale), columns - 1);
+    };
+    std::size_t i = 0;
+    while (i < rows) {
+        const double xi = static_cast<double>(x[i]);
+        if (!std::isfinite(xi)) {
+            keep(i++);
+            continue;
         }
-    }
-
-    // Add point style and size only if the plot style supports points.
-    if (is_point_style(plot_style)) {
-        // Add point style if specified.
-        oss << " pt " << this->point_style_to_string(point_style);
-        // Add point size if specified.
-        if (point_size > 0) {
-            oss << " ps " << point_size;
+        // The run spans the following points of the same column.
+        const std::size_t column = bucket(xi);
+        std::size_t end          = i + 1;
+        for (; end < rows; ++end) {
+            const double xj = static_cast<double>(x[end]);
+            if (!std::isfinite(xj) || (bucket(xj) != column)) {
+                break;
+            }
+        }
+        // The extremes of y are found by the vector kernels, non-finite
+        // values of y are kept and split the run.
+        std::size_t lowest = i, highest = i;
+        if (column_extrema(y, i, end, lowest, highest) == 0) {
+            keep_run(i, end, lowest, highest);
+            i = end;
+            continue;
+        }
+        while (i < end) {
+            if (!std::isfinite(static_cast<double>(y[i]))) {
+                keep(i++);
+                continue;
+            }
+            std::size_t part = i + 1;
+            while ((part < end) && std::isfinite(static_cast<double>(y[part]))) {
+                part++;
+            }
+            column_extrema(y, i, part, lowest, highest);
+            keep_run(i, part, lowest, highest);
+            i = part;
         }
     }
-
-    // Send the constructed command to Gnuplot for execution
-    this->send_cmd(oss.str());
-
-    return *this;
 }
 
-template <typename X, typename Y, typename Z>
-Gnuplot &Gnuplot::plot_3d_grid(const X &x, const Y &y, const Z &z, const std::string &title)
+/// @brief Reduces a series with y error bars to one bar per pixel column, keeping their envelope.
+/// @details Consecutive points falling in the same column are merged into
+/// their mean point, with a bar from their lowest `y - dy` to their highest
+/// `y + dy`. Points with a non-finite value are kept with their own bar.
+/// @param columns The number of pixel columns spanning the x range.
+/// @param envelope Receives the x, y, lowest and highest values of each bar.
+/// @return `true` if the series was reduced, `false` otherwise.
+template <typename X, typename Y, typename E>
+static inline typename std::enable_if<std::is_arithmetic<column_value_t<X>>::value &&
+                                          std::is_arithmetic<column_value_t<Y>>::value &&
+                                          std::is_arithmetic<column_value_t<E>>::value,
+                                      bool>::type
+decimate_envelope(const X &x, const Y &y, const E &dy, std::size_t columns, std::vector<double> (&envelope)[4])
 {
-    // Check if the Gnuplot session is ready
-    if (!this->is_ready()) {
-        std::cerr << "Error: Invalid Gnuplot session. Cannot plot.\n";
-        return *this;
+    const std::size_t rows = x.size();
+    double min = std::numeric_limits<double>::infinity(), max = -std::numeric_limits<double>::infinity();
+    extend_range(x, rows, min, max);
+    const double scale = (max > min) ? static_cast<double>(columns) / (max - min) : 0.0;
+    for (auto &values : envelope) {
+        values.reserve(columns);
     }
-
-    // Validate input dimensions
-    if (x.empty() || y.empty() || z.empty()) {
-        std::cerr << "Error: Input vectors must not be empty.\n";
-        return *this;
+    auto append = [&envelope](double xi, double yi, double low, double high) {
+        envelope[0].push_back(xi);
+        envelope[1].push_back(yi);
+        envelope[2].push_back(low);
+        envelope[3].push_back(high);
+    };
+
+    // Accumulate the points of the current run.
+    double sum_x = 0.0, sum_y = 0.0, low = 0.0, high = 0.0;
+    std::size_t count = 0, column = 0;
+    for (std::size_t i = 0; i < rows; ++i) {
+        const double xi = static_cast<double>(x[i]), yi = static_cast<double>(y[i]);
+        const double ei = std::fabs(static_cast<double>(dy[i]));
+        const bool finite = std::isfinite(xi) && std::isfinite(yi) && std::isfinite(ei);
+        const std::size_t bucket = finite ? std::min(static_cast<std::size_t>((xi - min) * scale), columns - 1) : 0;
+        if ((count > 0) && (!finite || (bucket != column))) {
+            append(sum_x / static_cast<double>(count), sum_y / static_cast<double>(count), low, high);
+            count = 0;
+        }
+        if (!finite) {
+            append(xi, yi, yi - ei, yi + ei);
+            continue;
+        }
+        if (count == 0) {
+            sum_x = sum_y = 0.0;
+            low           = yi - ei;
+            high          = yi + ei;
+            column        = bucket;
+        }
+        sum_x += xi;
+        sum_y += yi;
+        low  = std::min(low, yi - ei);
+        high = std::max(high, yi + ei);
+        count++;
     }
-    if (z.size() != x.size() || z[0].size() != y.size()) {
-        std::cerr << "Error: Dimensions of z must match sizes of x and y.\n";
-        return *this;
+    if (count > 0) {
+        append(sum_x / static_cast<double>(count), sum_y / static_cast<double>(count), low, high);
     }
+    return envelope[0].size() < rows;
+}
 
-    // Create a temporary file for storing the grid data
-    std::ofstream file;
-    std::string filename = this->create_tmpfile(file);
-    if (filename.empty()) {
-        std::cerr << "Error: Failed to create a temporary file.\n";
-        return *this;
+/// @brief Other series cannot be bucketed, they are not reduced.
+template <typename X, typename Y, typename E>
+static inline typename std::enable_if<!std::is_arithmetic<column_value_t<X>>::value ||
+                                          !std::is_arithmetic<column_value_t<Y>>::value ||
+                                          !std::is_arithmetic<column_value_t<E>>::value,
+                                      bool>::type
+decimate_envelope(const X &, const Y &, const E &, std::size_t, std::vector<double> (&)[4])
+{
+    return false;
+}
+
+/// @brief Other series cannot be bucketed, all their points are kept.
+template <typename X, typename Y>
+static inline typename std::enable_if<
+    !std::is_arithmetic<column_value_t<X>>::value || !std::is_arithmetic<column_value_t<Y>>::value>::type
+decimate_minmax(const X &x, const Y &, std::size_t, std::vector<std::size_t> &indices)
+{
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        indices.push_back(i);
     }
+}
 
-    // Write the grid data to the temporary file
-    for (size_t i = 0; i < x.size(); ++i) {
-        for (size_t j = 0; j < y.size(); ++j) {
-            if (!(file << x[i] << " " << y[j] << " " << z[i][j] << '\n')) {
-                std::cerr << "Error: Failed to write data to the temporary file: " << filename << '\n';
-                file.close();
-                return *this;
+/// @brief Keeps a fixed number of points with the largest-triangle-three-buckets algorithm.
+/// @details The first and last points are kept, the others are split into
+/// `points - 2` buckets, and each bucket keeps the point forming the largest
+/// triangle with the point kept before it and the average of the next bucket.
+/// Non-finite points are skipped: the triangles start from the last finite
+/// kept point, and a bucket followed by one without finite points keeps its
+/// point farthest in y from that kept point.
+/// @param points The number of kept points, at least 3 and less than the size of the series.
+/// @param indices Receives the indices of the kept points, in increasing order.
+template <typename X, typename Y>
+static inline typename std::enable_if<
+    std::is_arithmetic<column_value_t<X>>::value && std::is_arithmetic<column_value_t<Y>>::value>::type
+decimate_lttb(const X &x, const Y &y, std::size_t points, std::vector<std::size_t> &indices)
+{
+    const std::size_t rows = x.size();
+    const double every     = static_cast<double>(rows - 2) / static_cast<double>(points - 2);
+    double kept_x = static_cast<double>(x[0]), kept_y = static_cast<double>(y[0]);
+    indices.push_back(0);
+    for (std::size_t i = 0; i < points - 2; ++i) {
+        // Average the next bucket, which is the last point for the last bucket.
+        const std::size_t next = static_cast<std::size_t>(static_cast<double>(i + 1) * every) + 1;
+        const std::size_t end  = std::min(static_cast<std::size_t>(static_cast<double>(i + 2) * every) + 1, rows);
+        double average_x = 0.0, average_y = 0.0;
+        std::size_t count = 0;
+        for (std::size_t j = next; j < end; ++j) {
+            const double xj = static_cast<double>(x[j]), yj = static_cast<double>(y[j]);
+            if (std::isfinite(xj) && std::isfinite(yj)) {
+                average_x += xj;
+                average_y += yj;
+                count++;
             }
         }
-        file << "\n"; // Separate rows for Gnuplot
-    }
+        if (count > 0) {
+            average_x /= static_cast<double>(count);
+            average_y /= static_cast<double>(count);
+        }
 
-    // Flush and close the file
-    file.flush();
-    if (file.fail()) {
-        std::cerr << "Error: Failed to flush data to the temporary file: " << filename << '\n';
-        file.close();
-        return *this;
+        // Keep the finite point of the current bucket forming the largest
+        // triangle, or the farthest from the kept point without a next
+        // bucket, or the first one without a finite kept point.
+        const bool anchored     = std::isfinite(kept_x) && std::isfinite(kept_y);
+        const std::size_t begin = static_cast<std::size_t>(static_cast<double>(i) * every) + 1;
+        double largest          = -1.0;
+        std::size_t chosen      = begin;
+        for (std::size_t j = begin; j < next; ++j) {
+            const double xj = static_cast<double>(x[j]), yj = static_cast<double>(y[j]);
+            if (!std::isfinite(xj) || !std::isfinite(yj)) {
+                continue;
+            }
+            const double area = !anchored    ? 0.0
+                                : (count > 0) ? std::fabs((kept_x - average_x) * (yj - kept_y) -
+                                                          (kept_x - xj) * (average_y - kept_y))
+                                              : std::fabs(yj - kept_y);
+            if (area > largest) {
+                largest = area;
+                chosen  = j;
+            }
+        }
+        // A bucket without finite points keeps its first one, as a gap.
+        if (largest >= 0.0) {
+            kept_x = static_cast<double>(x[chosen]);
+            kept_y = static_cast<double>(y[chosen]);
+        }
+        indices.push_back(chosen);
     }
-    file.close();
+    indices.push_back(rows - 1);
+}
 
-    // Check if the file is available for reading
-    if (!this->file_ready(filename)) {
-        std::cerr << "Error: File " << filename << " is not available for reading.\n";
-        return *this;
+/// @brief Other series cannot be measured, all their points are kept.
+template <typename X, typename Y>
+static inline typename std::enable_if<
+    !std::is_arithmetic<column_value_t<X>>::value || !std::is_arithmetic<column_value_t<Y>>::value>::type
+decimate_lttb(const X &x, const Y &, std::size_t, std::vector<std::size_t> &indices)
+{
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        indices.push_back(i);
     }
+}
 
-    std::ostringstream oss;
-
-    // Determine whether to use 'splot' or 'replot' based on the current plot state
-    oss << ((nplots > 0 && !two_dim) ? "replot" : "splot");
-
-    // Specify the file and columns for the Gnuplot command
-    oss << " \"" << filename << "\" using 1:2:3";
-
-    // Add a title or specify 'notitle' if no title is provided
-    oss << (title.empty() ? " notitle" : " title \"" + title + "\"");
-
-    // Specify the plot style or smoothing option.
-    if (smooth_style == smooth_style_t::none) {
-        oss << " with " << this->plot_style_to_string(plot_style);
-    } else {
-        oss << " smooth " << this->smooth_style_to_string(smooth_style);
+/// @brief Builds the quantization mapping the range [min, max] over the available codes.
+static inline quantization_t make_quantization(double min, double max, bool invalid)
+{
+    quantization_t quantization;
+    quantization.invalid = invalid;
+    if (min <= max) {
+        quantization.offset = min;
+        quantization.scale  = (max > min) ? (max - min) / (GP_QUANTIZED_INVALID - 1) : 1.0;
     }
+    return quantization;
+}
 
-    // Include line color if it is specified.
-    if (!line_color.empty()) {
-        oss << " lc rgb \"" << line_color << "\"";
-    }
+/// @brief Builds the quantization covering the values of a column.
+template <typename Column>
+static inline typename std::enable_if<std::is_arithmetic<column_value_t<Column>>::value, quantization_t>::type
+quantize(const Column &column, std::size_t rows)
+{
+    double min = std::numeric_limits<double>::infinity(), max = -std::numeric_limits<double>::infinity();
+    const bool finite = extend_range(column, rows, min, max);
+    return make_quantization(min, max, !finite);
+}
 
-    // Add line style options only if the plot style supports lines.
-    if (is_line_style(plot_style)) {
-        // Add line width if specified.
-        if (line_width > 0) {
-            oss << " lw " << line_width;
-        }
-        // Add line style if specified.
-        if (!line_style.empty()) {
-            oss << " " << line_style;
-        }
-    }
+/// @brief Non-arithmetic columns are written as text, and never quantized.
+template <typename Column>
+static inline typename std::enable_if<!std::is_arithmetic<column_value_t<Column>>::value, quantization_t>::type
+quantize(const Column &, std::size_t)
+{
+    return quantization_t();
+}
 
-    // Add point style and size only if the plot style supports points.
-    if (is_point_style(plot_style)) {
-        // Add point style if specified.
-        oss << " pt " << this->point_style_to_string(point_style);
-        // Add point size if specified.
-        if (point_size > 0) {
-            oss << " ps " << point_size;
-        }
+/// @brief Gives the Gnuplot format specifier of a value stored with the given binary format.
+template <typename T>
+static inline typename std::enable_if<std::is_arithmetic<T>::value, const char *>::type
+binary_format(data_format_t format)
+{
+    switch (format) {
+    case data_format_t::binary_float32:
+        return "%float32";
+    case data_format_t::binary_uint16:
+        return "%uint16";
+    default:
+        return binary_traits<T>::format();
     }
+}
 
-    // Send the constructed command to Gnuplot for execution
-    this->send_cmd(oss.str());
-    return *this;
+/// @brief Non-arithmetic values are written as text, and have no binary format.
+template <typename T>
+static inline typename std::enable_if<!std::is_arithmetic<T>::value, const char *>::type binary_format(data_format_t)
+{
+    return "";
 }
 
-Gnuplot &Gnuplot::plot_slope(const double a, const double b, const std::string &title)
+/// @brief Converts a value to a double, NaN for non-arithmetic values, which are only written as text.
+template <typename T>
+static inline typename std::enable_if<std::is_arithmetic<T>::value, double>::type to_double(const T &value)
 {
-    std::ostringstream oss;
+    return static_cast<double>(value);
+}
 
-    // Determine whether to use 'plot' or 'replot' based on the current plot state.
-    oss << ((nplots > 0 && two_dim) ? "replot " : "plot ");
+template <typename T>
+static inline typename std::enable_if<!std::is_arithmetic<T>::value, double>::type to_double(const T &)
+{
+    return std::numeric_limits<double>::quiet_NaN();
+}
 
-    // Add the equation for the slope to the plot command.
-    oss << " " << a << " * x + " << b << " ";
+/// @brief Appends the raw bytes of a value to the buffer.
+template <typename T>
+static inline void append_raw(std::string &buffer, const T &value)
+{
+    buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
 
-    // Specify the equation and title for the plot.
-    if (title.empty()) {
-        oss << "title \"f(x) = " << a << " * x + " << b << "\"";
-    } else {
-        oss << "title \"" << title << "\"";
+/// @brief Appends a value to the buffer, encoded with the given binary format.
+template <typename T>
+static inline typename std::enable_if<std::is_arithmetic<T>::value>::type
+append_binary(std::string &buffer, const T &value, data_format_t format, const quantization_t &quantization)
+{
+    switch (format) {
+    case data_format_t::binary_float32:
+        append_raw(buffer, static_cast<float>(value));
+        break;
+    case data_format_t::binary_uint16: {
+        const double real = static_cast<double>(value);
+        append_raw(buffer, std::isfinite(real)
+                               ? static_cast<std::uint16_t>(std::lround((real - quantization.offset) / quantization.scale))
+                               : static_cast<std::uint16_t>(GP_QUANTIZED_INVALID));
+        break;
     }
-
-    // Specify the plot style or smoothing option.
-    if (smooth_style == smooth_style_t::none) {
-        oss << " with " << this->plot_style_to_string(plot_style);
-    } else {
-        oss << " smooth " << this->smooth_style_to_string(smooth_style);
+    default:
+        append_raw(buffer, static_cast<typename binary_traits<T>::type>(value));
+        break;
     }
+}
 
-    // Include line color if it is specified.
-    if (!line_color.empty()) {
-        oss << " lc rgb \"" << line_color << "\"";
-    }
+/// @brief Non-arithmetic values are written as text, and never appended as binary records.
+template <typename T>
+static inline typename std::enable_if<!std::is_arithmetic<T>::value>::type
+append_binary(std::string &, const T &, data_format_t, const quantization_t &)
+{
+}
 
-    // Add line style options only if the plot style supports lines.
-    if (is_line_style(plot_style)) {
-        // Add line width if specified.
-        if (line_width > 0) {
-            oss << " lw " << line_width;
-        }
-        // Add line style if specified.
-        if (!line_style.empty()) {
-            oss << " " << line_style;
-        }
+/// @brief Gives the expression reading back the given column in a `using` clause.
+/// @details Quantized columns are scaled back to their original range, and
+/// non-finite values are restored as NaN.
+static inline std::string using_column(std::size_t index, data_format_t format, const quantization_t &quantization)
+{
+    const std::string column = std::to_string(index);
+    if (format != data_format_t::binary_uint16) {
+        return column;
     }
-
-    // Add point style and size only if the plot style supports points.
-    if (is_point_style(plot_style)) {
-        // Add point style if specified.
-        oss << " pt " << this->point_style_to_string(point_style);
-        // Add point size if specified.
-        if (point_size > 0) {
-            oss << " ps " << point_size;
-        }
+    std::string expression = "(";
+    if (quantization.invalid) {
+        expression += "$" + column + "==" + std::to_string(GP_QUANTIZED_INVALID) + "?NaN:";
     }
-
-    // Send the constructed command to Gnuplot for execution
-    this->send_cmd(oss.str());
-
-    return *this;
+    expression += "$" + column + "*";
+    append_value(expression, quantization.scale, -1);
+    expression += (quantization.offset < 0) ? "-" : "+";
+    append_value(expression, std::fabs(quantization.offset), -1);
+    return expression + ")";
 }
 
-Gnuplot &Gnuplot::plot_equation(const std::string &equation, const std::string &title)
+/// @brief Terminates the recursion of write_binary_row.
+static inline void write_binary_row(std::string &, data_format_t, const quantization_t *, std::size_t)
 {
-    std::ostringstream oss;
-
-    // Determine whether to use 'plot' or 'replot' based on the current state.
-    oss << ((nplots > 0 && two_dim) ? "replot " : "plot ");
-
-    // Add the equation to be plotted.
-    oss << equation;
-
-    // Set the title or use 'notitle' if no title is provided.
-    oss << (title.empty() ? " notitle" : " title \"" + title + "\"");
+}
 
-    // Specify the plot style or smoothing option.
-    if (smooth_style == smooth_style_t::none) {
-        oss << " with " << this->plot_style_to_string(plot_style);
-    } else {
-        oss << " smooth " << this->smooth_style_to_string(smooth_style);
-    }
+/// @brief Appends the value at the given row of each column to the buffer, as a binary record.
+/// @param quantization The quantization of each column, used by quantized formats.
+template <typename Column, typename... Columns>
+static inline void write_binary_row(std::string &buffer,
+                                    data_format_t format,
+                                    const quantization_t *quantization,
+                                    std::size_t row,
+                                    const Column &column,
+                                    const Columns &...columns)
+{
+    append_binary(buffer, static_cast<column_value_t<Column>>(column[row]), format, *quantization);
+    write_binary_row(buffer, format, quantization + 1, row, columns...);
+}
 
-    // Include line color if it is specified.
-    if (!line_color.empty()) {
-        oss << " lc rgb \"" << line_color << "\"";
+/// @brief Streaming 64-bit hash of byte sequences, following the XXH64 algorithm.
+class hasher_t
+{
+public:
+    explicit hasher_t(std::uint64_t seed = 0)
+        : total(0),
+          size(0)
+    {
+        state[0] = seed + prime1 + prime2;
+        state[1] = seed + prime2;
+        state[2] = seed;
+        state[3] = seed - prime1;
+        hash     = seed + prime5;
     }
 
-    // Add line style options only if the plot style supports lines.
-    if (is_line_style(plot_style)) {
-        // Add line width if specified.
-        if (line_width > 0) {
-            oss << " lw " << line_width;
+    /// @brief Adds the given bytes to the hash.
+    void update(const void *data, std::size_t length)
+    {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        total += length;
+        // Complete the pending stripe first.
+        if (size > 0) {
+            const std::size_t copied = std::min(length, sizeof(stripe) - size);
+            std::memcpy(stripe + size, bytes, copied);
+            size += copied;
+            bytes += copied;
+            length -= copied;
+            if (size < sizeof(stripe)) {
+                return;
+            }
+            this->consume(stripe);
+            size = 0;
         }
-        // Add line style if specified.
-        if (!line_style.empty()) {
-            oss << " " << line_style;
+        for (; length >= sizeof(stripe); bytes += sizeof(stripe), length -= sizeof(stripe)) {
+            this->consume(bytes);
         }
+        std::memcpy(stripe, bytes, length);
+        size = length;
     }
 
-    // Add point style and size only if the plot style supports points.
-    if (is_point_style(plot_style)) {
-        // Add point style if specified.
-        oss << " pt " << this->point_style_to_string(point_style);
-        // Add point size if specified.
-        if (point_size > 0) {
-            oss << " ps " << point_size;
+    /// @brief Gives the hash of all the bytes added so far.
+    std::uint64_t digest() const
+    {
+        std::uint64_t result = hash;
+        if (total >= sizeof(stripe)) {
+            result = rotate(state[0], 1) + rotate(state[1], 7) + rotate(state[2], 12) + rotate(state[3], 18);
+            for (std::uint64_t lane : state) {
+                result = (result ^ round(0, lane)) * prime1 + prime4;
+            }
+        }
+        result += total;
+        std::size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            result = rotate(result ^ round(0, read<std::uint64_t>(stripe + i)), 27) * prime1 + prime4;
         }
+        for (; i + 4 <= size; i += 4) {
+            result = rotate(result ^ (read<std::uint32_t>(stripe + i) * prime1), 23) * prime2 + prime3;
+        }
+        for (; i < size; ++i) {
+            result = rotate(result ^ (stripe[i] * prime5), 11) * prime1;
+        }
+        result ^= result >> 33;
+        result *= prime2;
+        result ^= result >> 29;
+        result *= prime3;
+        return result ^ (result >> 32);
     }
 
-    // Send the constructed command to Gnuplot for execution.
-    this->send_cmd(oss.str());
-    return *this;
-}
-
-Gnuplot &Gnuplot::plot_equation3d(const std::string &equation, const std::string &title)
-{
-    std::ostringstream oss;
-
-    // Determine whether to use 'splot' or 'replot' based on the current state.
-    oss << ((nplots > 0 && !two_dim) ? "replot " : "splot ");
-
-    // Add the equation.
-    oss << equation;
+private:
+    static const std::uint64_t prime1 = 11400714785074694791ULL;
+    static const std::uint64_t prime2 = 14029467366897019727ULL;
+    static const std::uint64_t prime3 = 1609587929392839161ULL;
+    static const std::uint64_t prime4 = 9650029242287828579ULL;
+    static const std::uint64_t prime5 = 2870177450012600261ULL;
 
-    // Add the title or use a default title format.
-    if (title.empty()) {
-        oss << " title \"f(x, y) = " << equation << "\"";
-    } else {
-        oss << " title \"" << title << "\"";
+    static std::uint64_t rotate(std::uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
     }
 
-    // Specify the plot style or smoothing option.
-    if (smooth_style == smooth_style_t::none) {
-        oss << " with " << this->plot_style_to_string(plot_style);
-    } else {
-        oss << " smooth " << this->smooth_style_to_string(smooth_style);
+    static std::uint64_t round(std::uint64_t accumulator, std::uint64_t input)
+    {
+        return rotate(accumulator + input * prime2, 31) * prime1;
     }
 
-    // Include line color if it is specified.
-    if (!line_color.empty()) {
-        oss << " lc rgb \"" << line_color << "\"";
+    template <typename T>
+    static T read(const unsigned char *bytes)
+    {
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+        return value;
     }
 
-    // Add line style options only if the plot style supports lines.
-    if (is_line_style(plot_style)) {
-        // Add line width if specified.
-        if (line_width > 0) {
-            oss << " lw " << line_width;
-        }
-        // Add line style if specified.
-        if (!line_style.empty()) {
-            oss << " " << line_style;
+    void consume(const unsigned char *bytes)
+    {
+        for (int lane = 0; lane < 4; ++lane) {
+            state[lane] = round(state[lane], read<std::uint64_t>(bytes + 8 * lane));
         }
     }
 
-    // Add point style and size only if the plot style supports points.
-    if (is_point_style(plot_style)) {
-        // Add point style if specified.
-        oss << " pt " << this->point_style_to_string(point_style);
-        // Add point size if specified.
-        if (point_size > 0) {
-            oss << " ps " << point_size;
+    std::uint64_t state[4];
+    std::uint64_t hash;
+    std::uint64_t total;
+    unsigned char stripe[32];
+    std::size_t size;
+};
+
+/// @brief Adds the type and the first values of an arithmetic column to the hash.
+/// @return `true`, arithmetic columns can always be hashed.
+template <typename Column>
+static inline typename std::enable_if<std::is_arithmetic<column_value_t<Column>>::value, bool>::type
+hash_column(hasher_t &hasher, const Column &column, std::size_t rows)
+{
+    using value_t = column_value_t<Column>;
+    const std::uint64_t type = sizeof(value_t) | (std::is_floating_point<value_t>::value ? 0x100 : 0) |
+                               (std::is_signed<value_t>::value ? 0x200 : 0);
+    hasher.update(&type, sizeof(type));
+    // Gather the values in blocks, the container might not be contiguous.
+    value_t block[256];
+    for (std::size_t i = 0; i < rows; i += 256) {
+        const std::size_t count = std::min<std::size_t>(256, rows - i);
+        for (std::size_t j = 0; j < count; ++j) {
+            block[j] = static_cast<value_t>(column[i + j]);
         }
+        hasher.update(block, count * sizeof(value_t));
     }
+    return true;
+}
 
-    // Send the constructed command to Gnuplot for execution.
-    this->send_cmd(oss.str());
-    return *this;
+/// @brief Other columns are not hashed, their content is not made of plain bytes.
+template <typename Column>
+static inline typename std::enable_if<!std::is_arithmetic<column_value_t<Column>>::value, bool>::type
+hash_column(hasher_t &, const Column &, std::size_t)
+{
+    return false;
 }
 
-Gnuplot &Gnuplot::plot_image(const unsigned char *ucPicBuf,
-                             const unsigned int iWidth,
-                             const unsigned int iHeight,
-                             const std::string &title)
+/// @brief Computes the hash identifying the given columns, stored with the given encoding.
+/// @return `true` if the columns can be hashed, `false` otherwise.
+template <typename... Columns>
+static inline bool hash_columns(std::uint64_t &hash,
+                                data_format_t format,
+                                int precision,
+                                std::size_t rows,
+                                const Columns &...columns)
 {
-    // Create a temporary file to store image data
-    std::ofstream file;
-    std::string filename = create_tmpfile(file);
-    if (filename.empty()) {
-        std::cerr << "Error: Failed to create a temporary file for image plotting." << std::endl;
-        return *this; // Early return on failure
+    hasher_t hasher;
+    const std::uint64_t encoding[] = { static_cast<std::uint64_t>(format), static_cast<std::uint64_t>(precision),
+                                       static_cast<std::uint64_t>(rows), sizeof...(Columns) };
+    hasher.update(encoding, sizeof(encoding));
+    const bool hashed[] = { hash_column(hasher, columns, rows)... };
+    for (bool column : hashed) {
+        if (!column) {
+            return false;
+        }
     }
+    hash = hasher.digest();
+    return true;
+}
 
-    // Write the image data (width, height, pixel value) to the temporary file
-    int iIndex         = 0;
-    bool write_success = true;
-    for (unsigned int iRow = 0; iRow < iHeight && write_success; ++iRow) {
-        for (unsigned int iColumn = 0; iColumn < iWidth; ++iColumn) {
-            if (!(file << iColumn << " " << iRow << " " << static_cast<float>(ucPicBuf[iIndex++]) << std::endl)) {
-                std::cerr << "Error: Failed to write image data to temporary file: " << filename << std::endl;
-                write_success = false;
-                break;
+/// @brief Deletes a temporary file.
+static inline void delete_tmpfile(const std::string &name, int fd)
+{
+#if defined(GP_USE_MEMFD)
+    // Anonymous files are released together with their last descriptor.
+    if (fd != -1) {
+        close(fd);
+        return;
+    }
+#else
+    (void)fd;
+#endif
+    if (std::remove(name.c_str()) != 0) {
+        std::cerr << "Warning: Unable to remove temporary file \"" << name << "\".\n";
+    }
+}
+
+} // namespace detail
+
+Gnuplot::Gnuplot()
+    : gnuplot_pipe(nullptr),               // No active pipe initially
+      terminal_type(terminal_type_t::wxt), // Default terminal type is wxt
+      valid(false),                        // Invalid session by default
+      two_dim(true),                       // 2D plotting by default
+      nplots(0),                           // No plots initially
+      line_width(1.0),                     // Default line width
+      plot_style(plot_style_t::lines),     // Default plot style is lines
+      smooth_style(smooth_style_t::none),  // No smoothing by default
+      line_style(""),                      // No custom line style
+      line_color(""),                      // Default line color is unspecified
+      point_style(point_style_t::none),    // Default point style is none
+      point_size(-1.0),                    // Default point size is unspecified
+      data_format(data_format_t::text),    // Data is stored as text by default
+      data_transport(data_transport_t::file), // Data is stored inside files by default
+      fifo_stalled(false),                 // Named pipes are used when asked to
+      grid_layout(grid_layout_t::points),  // Grids are stored point by point by default
+      text_precision(-1),                  // Shortest round-trip text by default
+      decimation(decimation_t::none),      // All the points are written by default
+      decimation_size(GP_DECIMATION_SIZE), // Decimate to the width of a large screen
+      finite_check(false),                 // Non-finite values are drawn as gaps by default
+      value_lower(-std::numeric_limits<double>::infinity()), // Any value is accepted by default
+      value_upper(std::numeric_limits<double>::infinity()),
+      ndatablocks(0),                      // No datablocks initially
+      tmpfile_pool_size(GP_MAX_TMP_FILES), // Keep a few unused files for recycling
+      tmpfile_clock(0),                    // No temporary file used yet
+      tmpfile_synced(0),                   // No file released yet
+      fresh_clock(0),                      // No plot sent yet
+      sync_clock(0),                       // No marker requested yet
+      data_cache(false),                   // Data is not hashed by default
+      cache_hits(0),                       // No data reused yet
+      cache_misses(0),                     // No data written yet
+      tmpfile_quota(0),                    // No limit on the size of the temporary files
+      ndatasets(0),                        // No datasets initially
+      double_buffering(false),             // Datasets are updated in place by default
+      npyramids(0)                         // No pyramids initially
+{
+    // The first session removes the files left behind by crashed processes, if asked to.
+    static bool swept = false;
+    if (Gnuplot::m_sweep_orphans && !swept) {
+        swept = true;
+        Gnuplot::sweep_orphaned_tmpfiles();
+    }
+
+#if (defined(unix) || defined(__unix) || defined(__unix__)) && !defined(__APPLE__)
+    // Ensure DISPLAY is set for Unix systems.
+    if (!getenv("DISPLAY")) {
+        std::cerr << "Error: DISPLAY variable not set.\n";
+        valid = false;
+        return;
+    }
+#endif
+
+    // Check if gnuplot is available.
+    if (!Gnuplot::get_program_path()) {
+        std::cerr << "Error: Gnuplot executable not found.\n";
+        valid = false;
+        return;
+    }
+
+    // Try to open a pipe to Gnuplot.
+    gnuplot_pipe = OPEN_PIPE((Gnuplot::m_gnuplot_path + "/" + Gnuplot::m_gnuplot_filename).c_str(), "w");
+    if (!gnuplot_pipe) {
+        std::cerr << "Error: Unable to open pipe to Gnuplot.\n";
+        valid = false;
+        return;
+    }
+
+    // Initialize plotting state.
+    valid   = true;
+    nplots  = 0;
+    two_dim = false;
+
+    // Initialize styles.
+    plot_style   = plot_style_t::none;
+    smooth_style = smooth_style_t::none;
+    line_style.clear();
+    line_color.clear();
+    point_style = point_style_t::plus;
+    point_size  = -1.0;
+    line_width  = -1.0;
+    data_format    = data_format_t::text;
+    data_transport = data_transport_t::file;
+    fifo_stalled   = false;
+    grid_layout    = grid_layout_t::points;
+    text_precision = -1;
+    ndatablocks    = 0;
+
+    // Initialize contour settings.
+    contour.type  = contour_type_t::none;
+    contour.param = contour_param_t::levels;
+    contour.discrete_levels.clear();
+    contour.increment_start = 0.0;
+    contour.increment_step  = 0.1;
+    contour.increment_end   = 1.0;
+    contour.levels          = 10;
+
+    // Clear temporary file list.
+    tmpfile_list.clear();
+
+    // Set terminal type and initial plot settings.
+    this->showonscreen();
+}
+
+Gnuplot::~Gnuplot()
+{
+    // Close the communication pipe to Gnuplot if it's open
+    if (gnuplot_pipe) {
+        if (CLOSE_PIPE(gnuplot_pipe) == -1) {
+            std::cerr << "Warning: Problem closing communication to Gnuplot.\n";
+        }
+        // Avoid dangling pointer.
+        gnuplot_pipe = nullptr;
+    }
+
+    // Remove all temporary files created during the session, and the marker
+    // Gnuplot wrote, or gave up writing, before exiting.
+    remove_tmpfiles();
+    if (!sync_marker.empty()) {
+        std::remove(sync_marker.c_str());
+    }
+}
+
+Gnuplot &Gnuplot::send_cmd(const std::string &cmdstr)
+{
+    // Check if the Gnuplot session is ready.
+    if (!this->is_ready()) {
+        std::cerr << "Error: Invalid Gnuplot session not ready.\n";
+        this->discard_pending();
+        return *this;
+    }
+
+    // Write the command to the Gnuplot pipe.
+    fprintf(gnuplot_pipe, "%s\n", cmdstr.c_str());
+    fflush(gnuplot_pipe);
+
+    // Stream the data of named pipes, which Gnuplot reads in order while
+    // executing the command. They share a single deadline, and once one
+    // fails the following ones are released.
+    if (!pending_writes.empty()) {
+        std::vector<pending_write_t> writes;
+        writes.swap(pending_writes);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(GP_FIFO_TIMEOUT_MS);
+        bool success        = true;
+        for (const auto &write : writes) {
+            if (!success) {
+                this->release_fifo(write.name);
+                continue;
             }
+            data_sink_t fifo;
+            fifo.name      = write.name;
+            fifo.transport = data_transport_t::fifo;
+            fifo.deadline  = deadline;
+            success        = write.write(fifo);
         }
     }
 
-    // Ensure all data is written to the file and the file is closed properly
-    file.flush();
-    if (file.fail() || !write_success) {
-        file.close();
-        std::cerr << "Error: Failed to flush data to temporary file: " << filename << std::endl;
-        return *this; // Early return on failure
+    // Check and update state based on the command type.
+    bool fresh = false;
+    if (cmdstr.find("replot") != std::string::npos) {
+        // Do not increment plot count or change dimensionality.
+    }
+    // Command starts with "splot".
+    else if (cmdstr.find("splot") == 0) {
+        two_dim = false;
+        nplots++;
+        fresh = true;
+    }
+    // Command starts with "plot".
+    else if (cmdstr.find("plot") == 0) {
+        two_dim = true;
+        nplots++;
+        fresh = true;
     }
-    file.close();
 
-    // Check if the file is available for reading
-    if (this->file_ready(filename)) {
-        // Construct the Gnuplot command for plotting the image
-        std::ostringstream oss;
-        // Determine whether to use 'plot' or 'replot' based on the current plot state
-        oss << ((nplots > 0 && two_dim) ? "replot " : "plot ");
-        // Specify the file and plotting options
-        oss << "\"" << filename << "\" with image";
-        if (!title.empty()) {
-            oss << " title \"" << title << "\"";
-        }
-        // Send the constructed command to Gnuplot for execution
-        this->send_cmd(oss.str());
+    // The files written for this command now belong to the current plot.
+    this->update_tmpfiles(fresh);
+
+    return *this;
+}
+
+template <typename X>
+Gnuplot &Gnuplot::plot_x(const X &x, const std::string &title)
+{
+    // Discard the data written below if the plot command is not sent.
+    plot_guard_t guard{ *this };
+
+    // Check if the Gnuplot session is ready.
+    if (!this->is_ready()) {
+        std::cerr << "Error: Invalid Gnuplot session not ready.\n";
+        return *this;
+    }
+
+    // Check if the input vector is empty.
+    if (x.empty()) {
+        std::cerr << "Error: Input vector is empty. Cannot plot data." << std::endl;
+        return *this;
+    }
+
+    // Check the values themselves, not the decimated series.
+    if (!this->check_values(x.size(), x)) {
+        return *this;
+    }
+
+    // Store the data, according to the current transport. Decimated series
+    // are written with the index of each kept value as x coordinate.
+    std::vector<std::size_t> indices;
+    const bool decimated = this->decimate(detail::row_index_t{ x.size() }, x, indices);
+    const auto kept_x    = detail::gather(x, indices);
+    std::string source   = decimated ? this->write_columns(indices.size(), indices, kept_x)
+                                     : this->write_columns(x.size(), x);
+    if (source.empty()) {
+        return *this;
+    }
+
+    std::ostringstream oss;
+    // Determine whether to use 'plot' or 'replot' based on the current plot state.
+    oss << ((nplots > 0 && two_dim) ? "replot" : "plot");
+    // Specify the data source and columns for the Gnuplot command.
+    oss << " " << source;
+    // Add a title or specify 'notitle' if no title is provided.
+    oss << (title.empty() ? " notitle" : " title \"" + title + "\"");
+    // Add the plot style, line and point options
+    oss << this->style_options();
+    // Send the constructed command to Gnuplot for execution
+    this->send_cmd(oss.str());
+
+    return *this;
+}
+
+template <typename X>
+Gnuplot &Gnuplot::plot_x(const std::vector<X> &datasets, const std::vector<std::string> &titles)
+{
+    // Discard the data written below if the plot command is not sent.
+    plot_guard_t guard{ *this };
+
+    // Check if the Gnuplot session is ready
+    if (!this->is_ready()) {
+        std::cerr << "Error: Invalid Gnuplot session not ready.\n";
+        return *this;
+    }
+
+    // Validate input data
+    if (datasets.empty()) {
+        std::cerr << "Error: Input datasets are empty. Cannot plot.\n";
+        return *this;
+    }
+
+    if (!titles.empty() && titles.size() != datasets.size()) {
+        std::cerr << "Error: Mismatch between the number of datasets and titles.\n";
+        return *this;
+    }
+
+    // Select the datasets which can be plotted
+    std::vector<size_t> indices;
+    indices.reserve(datasets.size());
+    for (size_t i = 0; i < datasets.size(); ++i) {
+        if (datasets[i].empty()) {
+            std::cerr << "Error: Dataset " << i + 1 << " is empty. Skipping.\n";
+            continue;
+        }
+        if (!this->check_values(datasets[i].size(), datasets[i])) {
+            return *this;
+        }
+        indices.push_back(i);
+    }
+
+    if (indices.empty()) {
+        std::cerr << "Error: No valid datasets to plot.\n";
+        return *this;
+    }
+
+    // Store all the datasets together, according to the current transport.
+    // When some of them are decimated, each dataset is written apart instead,
+    // decimated ones with the index of each kept value as x coordinate; the
+    // views must outlive the plot command, named pipes are written while it runs.
+    std::vector<std::vector<std::size_t>> kept(indices.size());
+    std::vector<char> decimated(indices.size());
+    bool apart = false;
+    for (size_t i = 0; i < indices.size(); ++i) {
+        const X &dataset = datasets[indices[i]];
+        decimated[i]     = this->decimate(detail::row_index_t{ dataset.size() }, dataset, kept[i]);
+        apart            = apart || decimated[i];
+    }
+    std::vector<detail::gather_t<X>> kept_values;
+    kept_values.reserve(indices.size());
+    std::vector<std::string> sources;
+    for (size_t i = 0; apart && (i < indices.size()); ++i) {
+        const X &dataset = datasets[indices[i]];
+        kept_values.push_back(detail::gather(dataset, kept[i]));
+        sources.push_back(decimated[i] ? this->write_columns(kept[i].size(), kept[i], kept_values.back())
+                                       : this->write_columns(dataset.size(), dataset));
+        if (sources.back().empty()) {
+            return *this;
+        }
+    }
+    if (!apart) {
+        sources = this->write_datasets(datasets, indices);
+    }
+    if (sources.empty()) {
+        return *this;
+    }
+
+    std::ostringstream oss;
+
+    // Determine the command ('plot' or 'replot')
+    oss << ((nplots > 0 && two_dim) ? "replot " : "plot ");
+
+    // Construct the plotting command for each dataset
+    for (size_t i = 0; i < sources.size(); ++i) {
+        oss << sources[i];
+
+        // Add title
+        if (titles.empty() || titles[indices[i]].empty()) {
+            oss << " notitle";
+        } else {
+            oss << " title \"" << titles[indices[i]] << "\"";
+        }
+
+        // Add the plot style, line and point options
+        oss << this->style_options();
+
+        // Add a comma unless it's the last dataset
+        if (i != sources.size() - 1) {
+            oss << ", ";
+        }
+    }
+
+    // Send the constructed command to Gnuplot
+    this->send_cmd(oss.str());
+
+    return *this;
+}
+
+template <typename X, typename Y>
+Gnuplot &Gnuplot::plot_xy(const X &x, const Y &y, const std::string &title)
+{
+    // Discard the data written below if the plot command is not sent.
+    plot_guard_t guard{ *this };
+
+    // Check if the Gnuplot session is ready
+    if (!this->is_ready()) {
+        std::cerr << "Error: Invalid Gnuplot session. Cannot plot.\n";
+        return *this;
+    }
+
+    // Validate input vectors
+    if (x.empty() || y.empty()) {
+        std::cerr << "Error: Input vectors are empty. Cannot plot.\n";
+        return *this;
     }
+
+    if (x.size() != y.size()) {
+        std::cerr << "Error: Mismatch between the lengths of x and y vectors.\n";
+        return *this;
+    }
+
+    // Check the values themselves, not the decimated series.
+    if (!this->check_values(x.size(), x, y)) {
+        return *this;
+    }
+
+    // Store the data inside a temporary file, only the visible points if decimated. The
+    // views must outlive the plot command, named pipes are written while it runs.
+    std::vector<std::size_t> indices;
+    const bool decimated = this->decimate(x, y, indices);
+    const auto kept_x    = detail::gather(x, indices);
+    const auto kept_y    = detail::gather(y, indices);
+    std::string source   = decimated ? this->write_columns(indices.size(), kept_x, kept_y)
+                                     : this->write_columns(x.size(), x, y);
+    if (source.empty()) {
+        return *this;
+    }
+
+    std::ostringstream oss;
+    // Determine whether to use 'plot' or 'replot' based on the current plot state
+    oss << ((nplots > 0 && two_dim) ? "replot" : "plot");
+    // Specify the data source and columns for the Gnuplot command
+    oss << " " << source;
+    // Add a title or specify 'notitle' if no title is provided
+    oss << (title.empty() ? " notitle" : " title \"" + title + "\"");
+    // Add the plot style, line and point options
+    oss << this->style_options();
+    // Send the constructed command to Gnuplot for execution
+    this->send_cmd(oss.str());
+
+    return *this;
+}
+
+template <typename X, typename Y, typename E>
+Gnuplot &
+Gnuplot::plot_xy_erorrbar(const X &x, const Y &y, const E &dy, erorrbar_style_t style, const std::string &title)
+{
+    // Discard the data written below if the plot command is not sent.
+    plot_guard_t guard{ *this };
+
+    // Check if the Gnuplot session is ready
+    if (!this->is_ready()) {
+        std::cerr << "Error: Invalid Gnuplot session. Cannot plot.\n";
+        return *this;
+    }
+
+    // Validate input vectors
+    if (x.empty() || y.empty() || dy.empty()) {
+        std::cerr << "Error: Input vectors are empty. Cannot plot.\n";
+        return *this;
+    }
+
+    if (x.size() != y.size() || x.size() != dy.size()) {
+        std::cerr << "Error: Mismatch between the lengths of x, y, and dy vectors.\n";
+        return *this;
+    }
+
+    // Check the values themselves, not the envelope of the decimated bars
+    if (!this->check_values(x.size(), x, y, dy)) {
+        return *this;
+    }
+
+    // Store the data inside a temporary file, one bar per pixel column if decimated
+    std::vector<double> envelope[4];
+    const std::size_t limit = this->decimation_limit();
+    const bool decimated    = (limit > 0) && (style == erorrbar_style_t::yerrorbars) && (x.size() > limit) &&
+                              detail::decimate_envelope(x, y, dy, decimation_size, envelope);
+    std::string source = decimated ? this->write_columns(envelope[0].size(), envelope[0], envelope[1], envelope[2],
+                                                         envelope[3])
+                                   : this->write_columns(x.size(), x, y, dy);
+    if (source.empty()) {
+        return *this;
+    }
+
+    std::ostringstream oss;
+
+    // Determine whether to use 'plot' or 'replot' based on the current plot state
+    oss << ((nplots > 0 && two_dim) ? "replot " : "plot ");
+
+    // Specify the data source and columns for the Gnuplot command
+    oss << source << " with " << this->errorbars_to_string(style) << " ";
+
+    // Add a title or specify 'notitle' if no title is provided
+    oss << (title.empty() ? " notitle " : " title \"" + title + "\" ");
+
+    // Include line color if it is specified.
+    if (!line_color.empty()) {
+        oss << " lc rgb \"" << line_color << "\"";
+    }
+
+    // Add line width if specified.
+    if (line_width > 0) {
+        oss << " lw " << line_width;
+    }
+    // Add line style if specified.
+    if (!line_style.empty()) {
+        oss << " " << line_style;
+    }
+
+    // Add point style if specified.
+    oss << " pt " << this->point_style_to_string(point_style);
+    // Add point size if specified.
+    if (point_size > 0) {
+        oss << " ps " << point_size;
+    }
+
+    // Send the constructed command to Gnuplot for execution
+    this->send_cmd(oss.str());
+
+    return *this;
+}
+
+template <typename X, typename Y, typename Z>
+Gnuplot &Gnuplot::plot_xyz(const X &x, const Y &y, const Z &z, const std::string &title)
+{
+    // Discard the data written below if the plot command is not sent.
+    plot_guard_t guard{ *this };
+
+    // Check if the Gnuplot session is ready
+    if (!this->is_ready()) {
+        std::cerr << "Error: Invalid Gnuplot session. Cannot plot.\n";
+        return *this;
+    }
+
+    // Validate input vectors
+    if (x.empty() || y.empty() || z.empty()) {
+        std::cerr << "Error: Input vectors are empty. Cannot plot.\n";
+        return *this;
+    }
+
+    if (x.size() != y.size() || x.size() != z.size()) {
+        std::cerr << "Error: Mismatch between the lengths of x, y, and z vectors.\n";
+        return *this;
+    }
+
+    if (!this->check_values(x.size(), x, y, z)) {
+        return *this;
+    }
+
+    // Store the data inside a temporary file
+    std::string source = this->write_columns(x.size(), x, y, z);
+    if (source.empty()) {
+        return *this;
+    }
+
+    std::ostringstream oss;
+
+    // Determine whether to use 'splot' or 'replot' based on the current plot state
+    oss << ((nplots > 0 && !two_dim) ? "replot" : "splot");
+
+    // Specify the data source and columns for the Gnuplot command
+    oss << " " << source;
+
+    // Add a title or specify 'notitle' if no title is provided
+    oss << (title.empty() ? " notitle" : " title \"" + title + "\"");
+
+    // Add the plot style, line and point options
+    oss << this->style_options();
+
+    // Send the constructed command to Gnuplot for execution
+    this->send_cmd(oss.str());
+
+    return *this;
+}
+
+template <typename X, typename Y, typename Z>
+Gnuplot &Gnuplot::plot_3d_grid(const X &x, const Y &y, const Z &z, const std::string &title)
+{
+    // Discard the data written below if the plot command is not sent.
+    plot_guard_t guard{ *this };
+
+    // Check if the Gnuplot session is ready
+    if (!this->is_ready()) {
+        std::cerr << "Error: Invalid Gnuplot session. Cannot plot.\n";
+        return *this;
+    }
+
+    // Validate input dimensions
+    if (x.empty() || y.empty() || z.empty()) {
+        std::cerr << "Error: Input vectors must not be empty.\n";
+        return *this;
+    }
+    if (z.size() != x.size() || z[0].size() != y.size()) {
+        std::cerr << "Error: Dimensions of z must match sizes of x and y.\n";
+        return *this;
+    }
+
+    // Store the grid data, according to the current layout, matrices only hold numbers
+    const bool matrix = (grid_layout == grid_layout_t::matrix) &&
+                        detail::all_arithmetic<X, Y, detail::column_value_t<Z>>::value;
+    std::string source = matrix ? this->write_matrix(x, y, z) : this->write_grid(x, y, z);
+    if (source.empty()) {
+        return *this;
+    }
+
+    std::ostringstream oss;
+
+    // Determine whether to use 'splot' or 'replot' based on the current plot state
+    oss << ((nplots > 0 && !two_dim) ? "replot" : "splot");
+
+    // Specify the data source and columns for the Gnuplot command
+    oss << " " << source;
+
+    // Add a title or specify 'notitle' if no title is provided
+    oss << (title.empty() ? " notitle" : " title \"" + title + "\"");
+
+    // Add the plot style, line and point options
+    oss << this->style_options();
+
+    // Send the constructed command to Gnuplot for execution
+    this->send_cmd(oss.str());
+    return *this;
+}
+
+Gnuplot &Gnuplot::plot_slope(const double a, const double b, const std::string &title)
+{
+    std::ostringstream oss;
+
+    // Determine whether to use 'plot' or 'replot' based on the current plot state.
+    oss << ((nplots > 0 && two_dim) ? "replot " : "plot ");
+
+    // Add the equation for the slope to the plot command.
+    oss << " " << a << " * x + " << b << " ";
+
+    // Specify the equation and title for the plot.
+    if (title.empty()) {
+        oss << "title \"f(x) = " << a << " * x + " << b << "\"";
+    } else {
+        oss << "title \"" << title << "\"";
+    }
+
+    // Add the plot style, line and point options
+    oss << this->style_options();
+
+    // Send the constructed command to Gnuplot for execution
+    this->send_cmd(oss.str());
+
+    return *this;
+}
+
+Gnuplot &Gnuplot::plot_equation(const std::string &equation, const std::string &title)
+{
+    std::ostringstream oss;
+
+    // Determine whether to use 'plot' or 'replot' based on the current state.
+    oss << ((nplots > 0 && two_dim) ? "replot " : "plot ");
+
+    // Add the equation to be plotted.
+    oss << equation;
+
+    // Set the title or use 'notitle' if no title is provided.
+    oss << (title.empty() ? " notitle" : " title \"" + title + "\"");
+
+    // Add the plot style, line and point options
+    oss << this->style_options();
+
+    // Send the constructed command to Gnuplot for execution.
+    this->send_cmd(oss.str());
+    return *this;
+}
+
+Gnuplot &Gnuplot::plot_equation3d(const std::string &equation, const std::string &title)
+{
+    std::ostringstream oss;
+
+    // Determine whether to use 'splot' or 'replot' based on the current state.
+    oss << ((nplots > 0 && !two_dim) ? "replot " : "splot ");
+
+    // Add the equation.
+    oss << equation;
+
+    // Add the title or use a default title format.
+    if (title.empty()) {
+        oss << " title \"f(x, y) = " << equation << "\"";
+    } else {
+        oss << " title \"" << title << "\"";
+    }
+
+    // Add the plot style, line and point options
+    oss << this->style_options();
+
+    // Send the constructed command to Gnuplot for execution.
+    this->send_cmd(oss.str());
+    return *this;
+}
+
+Gnuplot &Gnuplot::plot_image(const unsigned char *ucPicBuf,
+                             const unsigned int iWidth,
+                             const unsigned int iHeight,
+                             const std::string &title)
+{
+    // Discard the data written below if the plot command is not sent.
+    plot_guard_t guard{ *this };
+
+    // Create a temporary file to store image data
+    data_sink_t sink;
+    if (!this->open_sink(sink, data_transport_t::file)) {
+        std::cerr << "Error: Failed to create a temporary file for image plotting." << std::endl;
+        return *this; // Early return on failure
+    }
+
+    // Dump the pixels verbatim, the coordinates are implied by the array layout
+    const std::size_t size   = static_cast<std::size_t>(iWidth) * static_cast<std::size_t>(iHeight);
+    const bool write_success = this->write_sink(sink, reinterpret_cast<const char *>(ucPicBuf), size);
+
+    // Ensure all data is written to the file and the file is closed properly
+    const std::string source = this->close_sink(sink);
+    if (!write_success || source.empty()) {
+        std::cerr << "Error: Failed to write image data to temporary file: " << sink.name << std::endl;
+        return *this; // Early return on failure
+    }
+
+    // Construct the Gnuplot command for plotting the image
+    std::ostringstream oss;
+    // Determine whether to use 'plot' or 'replot' based on the current plot state
+    oss << ((nplots > 0 && two_dim) ? "replot " : "plot ");
+    // Specify the file, its layout (one row after the other), and plotting options
+    oss << source << " binary array=(" << iWidth << "," << iHeight << ") format='%uchar' with image";
+    if (!title.empty()) {
+        oss << " title \"" << title << "\"";
+    }
+    // Send the constructed command to Gnuplot for execution
+    this->send_cmd(oss.str());
+    return *this;
+}
+
+Gnuplot &Gnuplot::plot_dataset(const dataset_t &dataset, const std::string &title, const std::string &columns)
+{
+    return this->send_dataset_plot(dataset, title, columns, true);
+}
+
+Gnuplot &Gnuplot::splot_dataset(const dataset_t &dataset, const std::string &title, const std::string &columns)
+{
+    return this->send_dataset_plot(dataset, title, columns, false);
+}
+
+Gnuplot &Gnuplot::send_dataset_plot(const dataset_t &dataset,
+                                    const std::string &title,
+                                    const std::string &columns,
+                                    bool plane)
+{
+    // Discard the data written below if the plot command is not sent.
+    plot_guard_t guard{ *this };
+
+    // Check if the Gnuplot session is ready
+    if (!this->is_ready()) {
+        std::cerr << "Error: Invalid Gnuplot session. Cannot plot.\n";
+        return *this;
+    }
+
+    const dataset_entry_t *entry = this->find_dataset(dataset);
+    tmpfile_t *tmpfile           = entry ? this->find_tmpfile(entry->name) : nullptr;
+    if (!tmpfile) {
+        std::cerr << "Error: Invalid dataset. Cannot plot.\n";
+        return *this;
+    }
+
+    std::ostringstream oss;
+    // Determine whether to use 'plot', 'splot' or 'replot' based on the current plot state
+    if (plane) {
+        oss << ((nplots > 0 && two_dim) ? "replot" : "plot");
+    } else {
+        oss << ((nplots > 0 && !two_dim) ? "replot" : "splot");
+    }
+    // Read all the records of the file, up to its end, so that appended ones are plotted too
+    oss << " \"" << entry->name << "\"";
+    if (!entry->layout.empty()) {
+        oss << " " << entry->layout;
+    }
+    // Select the given columns, or all of them in order
+    if (!columns.empty()) {
+        oss << " using " << columns;
+    } else {
+        for (std::size_t i = 0; i < entry->columns; ++i) {
+            oss << ((i == 0) ? " using " : ":") << i + 1;
+        }
+    }
+    // Add a title or specify 'notitle' if no title is provided
+    oss << (title.empty() ? " notitle" : " title \"" + title + "\"");
+    // Add the plot style, line and point options
+    oss << this->style_options();
+    // The command reads the file, which is written only once whatever the number of plots
+    tmpfile->pending++;
+    this->send_cmd(oss.str());
+    return *this;
+}
+
+Gnuplot &Gnuplot::remove_dataset(dataset_t &dataset)
+{
+    for (std::size_t i = 0; i < dataset_list.size(); ++i) {
+        if (dataset_list[i].id != dataset.id) {
+            continue;
+        }
+        // The file is deleted or recycled once no plot reads it anymore.
+        tmpfile_t *tmpfile = this->find_tmpfile(dataset_list[i].name);
+        if (tmpfile && (tmpfile->holders > 0)) {
+            tmpfile->holders--;
+            tmpfile->last_use = ++tmpfile_clock;
+        }
+        dataset_list.erase(dataset_list.begin() + static_cast<std::ptrdiff_t>(i));
+        this->trim_tmpfiles();
+        break;
+    }
+    dataset.id = 0;
+    return *this;
+}
+
+Gnuplot &Gnuplot::plot_pyramid(const pyramid_t &pyramid, double xmin, double xmax, const std::string &title)
+{
+    // Discard the data written below if the plot command is not sent.
+    plot_guard_t guard{ *this };
+
+    // Check if the Gnuplot session is ready
+    if (!this->is_ready()) {
+        std::cerr << "Error: Invalid Gnuplot session. Cannot plot.\n";
+        return *this;
+    }
+
+    const pyramid_entry_t *entry = nullptr;
+    for (const auto &candidate : pyramid_list) {
+        if ((pyramid.id != 0) && (candidate.id == pyramid.id)) {
+            entry = &candidate;
+        }
+    }
+    if (!entry) {
+        std::cerr << "Error: Invalid pyramid. Cannot plot.\n";
+        return *this;
+    }
+
+    // Find the points of the window, and their outer neighbours.
+    const std::vector<double> &x = *entry->x;
+    std::size_t begin = static_cast<std::size_t>(std::lower_bound(x.begin(), x.end(), xmin) - x.begin());
+    std::size_t end   = static_cast<std::size_t>(std::upper_bound(x.begin(), x.end(), xmax) - x.begin());
+    begin             = (begin > 0) ? begin - 1 : 0;
+    end               = std::min(end + 1, x.size());
+    if (begin >= end) {
+        std::cerr << "Error: The window holds no point. Cannot plot.\n";
+        return *this;
+    }
+
+    // Windows which already fit the plot, or plots without decimation, are
+    // written as they are, the others through the lowest and highest points
+    // of the blocks covering them.
+    std::vector<std::size_t> indices;
+    const std::size_t points = end - begin;
+    const std::size_t limit  = this->decimation_limit();
+    if ((limit == 0) || (points <= limit) || entry->lowest.empty()) {
+        // All the rows of the window are viewed, without listing them.
+    } else {
+        std::size_t level = 0;
+        while ((level + 1 < entry->lowest.size()) && ((points >> level) > 2 * GP_PYRAMID_STRIDE * decimation_size)) {
+            level++;
+        }
+        const std::size_t stride = static_cast<std::size_t>(GP_PYRAMID_STRIDE) << level;
+        const std::size_t last   = std::min((end - 1) / stride, entry->lowest[level].size() - 1);
+        // The outer neighbours are always kept, so that lines reach the edges.
+        indices.reserve(2 * (last - begin / stride + 1) + 2);
+        indices.push_back(begin);
+        for (std::size_t block = begin / stride; block <= last; ++block) {
+            // Blocks crossing the edges of the window only keep the points inside it.
+            const std::size_t first = std::max(block * stride, begin);
+            const std::size_t stop  = std::min((block + 1) * stride, end);
+            std::size_t lowest = entry->lowest[level][block], highest = entry->highest[level][block];
+            if ((first != block * stride) || (stop != std::min((block + 1) * stride, x.size()))) {
+                Gnuplot::pyramid_extrema(*entry, first, stop, lowest, highest);
+            }
+            if (lowest == static_cast<std::size_t>(-1)) {
+                continue;
+            }
+            for (std::size_t index : { std::min(lowest, highest), std::max(lowest, highest) }) {
+                if (index > indices.back()) {
+                    indices.push_back(index);
+                }
+            }
+        }
+        if (end - 1 > indices.back()) {
+            indices.push_back(end - 1);
+        }
+    }
+
+    // Store the selected points, read from the series shared with the caller.
+    // The views outlive the plot command, named pipes are written while it runs.
+    const std::size_t rows = indices.empty() ? points : indices.size();
+    const detail::series_view_t kept_x{ *entry->x, indices, begin, rows };
+    const detail::series_view_t kept_y{ *entry->y, indices, begin, rows };
+    std::string source = this->write_columns(rows, kept_x, kept_y);
+    if (source.empty()) {
+        return *this;
+    }
+
+    std::ostringstream oss;
+    // Determine whether to use 'plot' or 'replot' based on the current plot state
+    oss << ((nplots > 0 && two_dim) ? "replot" : "plot");
+    oss << " " << source;
+    // Add a title or specify 'notitle' if no title is provided
+    oss << (title.empty() ? " notitle" : " title \"" + title + "\"");
+    // Add the plot style, line and point options
+    oss << this->style_options();
+    this->send_cmd(oss.str());
+    return *this;
+}
+
+pyramid_t Gnuplot::create_pyramid(std::shared_ptr<const std::vector<double>> x,
+                                  std::shared_ptr<const std::vector<double>> y)
+{
+    if (!x || !y) {
+        std::cerr << "Error: Missing series. Cannot index it.\n";
+        return pyramid_t();
+    }
+    if (x->size() != y->size()) {
+        std::cerr << "Error: Mismatch between the lengths of x and y vectors.\n";
+        return pyramid_t();
+    }
+    if (!this->check_values(x->size(), *x, *y)) {
+        return pyramid_t();
+    }
+    for (std::size_t i = 0; i < x->size(); ++i) {
+        if (!std::isfinite((*x)[i]) || ((i > 0) && ((*x)[i] < (*x)[i - 1]))) {
+            std::cerr << "Error: The x coordinates of a pyramid must be finite and sorted.\n";
+            return pyramid_t();
+        }
+    }
+
+    // The pyramid shares the series, and only stores the extremes of its blocks.
+    pyramid_entry_t entry;
+    entry.id = ++npyramids;
+    entry.x  = std::move(x);
+    entry.y  = std::move(y);
+    this->build_pyramid(entry);
+    pyramid_list.push_back(std::move(entry));
+
+    pyramid_t pyramid;
+    pyramid.id = pyramid_list.back().id;
+    return pyramid;
+}
+
+Gnuplot &Gnuplot::remove_pyramid(pyramid_t &pyramid)
+{
+    for (std::size_t i = 0; i < pyramid_list.size(); ++i) {
+        if (pyramid_list[i].id == pyramid.id) {
+            pyramid_list.erase(pyramid_list.begin() + static_cast<std::ptrdiff_t>(i));
+            break;
+        }
+    }
+    pyramid.id = 0;
+    return *this;
+}
+
+void Gnuplot::build_pyramid(pyramid_entry_t &entry)
+{
+    const std::size_t none = static_cast<std::size_t>(-1);
+    const std::vector<double> &y = *entry.y;
+    const std::size_t rows       = y.size();
+    if (rows <= GP_PYRAMID_STRIDE) {
+        return;
+    }
+
+    // The smallest blocks are scanned by the vector kernels.
+    std::vector<std::size_t> lowest, highest;
+    lowest.reserve(rows / GP_PYRAMID_STRIDE + 1);
+    highest.reserve(rows / GP_PYRAMID_STRIDE + 1);
+    for (std::size_t first = 0; first < rows; first += GP_PYRAMID_STRIDE) {
+        const std::size_t end = std::min<std::size_t>(first + GP_PYRAMID_STRIDE, rows);
+        std::size_t low = end, high = end;
+        detail::column_extrema(y, first, end, low, high);
+        lowest.push_back((low == end) ? none : low);
+        highest.push_back((high == end) ? none : high);
+    }
+    entry.lowest.push_back(std::move(lowest));
+    entry.highest.push_back(std::move(highest));
+
+    // Each level merges the blocks of the previous one by pairs, ties go to the first point.
+    while (entry.lowest.back().size() > 1) {
+        const std::vector<std::size_t> &lows = entry.lowest.back(), &highs = entry.highest.back();
+        const std::size_t blocks = (lows.size() + 1) / 2;
+        std::vector<std::size_t> low_level(blocks), high_level(blocks);
+        for (std::size_t block = 0; block < blocks; ++block) {
+            const std::size_t a = 2 * block, b = std::min(2 * block + 1, lows.size() - 1);
+            low_level[block]  = ((lows[a] == none) || ((lows[b] != none) && (y[lows[b]] < y[lows[a]]))) ? lows[b]
+                                                                                                        : lows[a];
+            high_level[block] = ((highs[a] == none) || ((highs[b] != none) && (y[highs[b]] > y[highs[a]])))
+                                    ? highs[b]
+                                    : highs[a];
+        }
+        entry.lowest.push_back(std::move(low_level));
+        entry.highest.push_back(std::move(high_level));
+    }
+}
+
+void Gnuplot::pyramid_extrema(
+    const pyramid_entry_t &entry, std::size_t first, std::size_t last, std::size_t &lowest, std::size_t &highest)
+{
+    const std::size_t none       = static_cast<std::size_t>(-1);
+    const std::vector<double> &y = *entry.y;
+    lowest = highest = none;
+    while (first < last) {
+        // Take the largest block starting at the row and ending before the
+        // last one, or the row alone outside of the smallest blocks.
+        std::size_t level = 0, size = GP_PYRAMID_STRIDE, low = none, high = none;
+        if (entry.lowest.empty() || (first % size != 0) || (std::min(first + size, y.size()) > last)) {
+            low = high = std::isfinite(y[first]) ? first : none;
+            size       = 1;
+        } else {
+            while ((level + 1 < entry.lowest.size()) && (first % (2 * size) == 0) &&
+                   (std::min(first + 2 * size, y.size()) <= last)) {
+                level++;
+                size *= 2;
+            }
+            low  = entry.lowest[level][first / size];
+            high = entry.highest[level][first / size];
+        }
+        // The rows come in increasing order, ties go to the first one.
+        if ((low != none) && ((lowest == none) || (y[low] < y[lowest]))) {
+            lowest = low;
+        }
+        if ((high != none) && ((highest == none) || (y[high] > y[highest]))) {
+            highest = high;
+        }
+        first += size;
+    }
+}
+
+Gnuplot::dataset_entry_t *Gnuplot::find_dataset(const dataset_t &dataset)
+{
+    for (auto &entry : dataset_list) {
+        if ((dataset.id != 0) && (entry.id == dataset.id)) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+std::size_t Gnuplot::get_dataset_version(const dataset_t &dataset)
+{
+    const dataset_entry_t *entry = this->find_dataset(dataset);
+    return entry ? entry->version : 0;
+}
+
+Gnuplot &Gnuplot::refresh_dataset(dataset_entry_t &entry)
+{
+    entry.version++;
+    // Show the new records if the current plot reads the dataset.
+    const tmpfile_t *tmpfile = this->find_tmpfile(entry.name);
+    if (tmpfile && (tmpfile->refs > 0) && (nplots > 0)) {
+        this->send_cmd("replot");
+    }
+    return *this;
+}
+
+bool Gnuplot::open_dataset_sink(dataset_entry_t &entry,
+                                data_sink_t &sink,
+                                dataset_write_t mode,
+                                const std::string &layout)
+{
+    sink.transport     = data_transport_t::file;
+    tmpfile_t *tmpfile = this->find_tmpfile(entry.name);
+    if (mode == dataset_write_t::create) {
+        // A new file, held by the dataset rather than by a command. Double
+        // buffered datasets need a name in a filesystem, to be renamed over.
+        if (!this->open_sink(sink, data_transport_t::file, entry.double_buffered)) {
+            return false;
+        }
+        tmpfile = this->find_tmpfile(sink.name);
+        tmpfile->pending--;
+        tmpfile->holders++;
+        entry.name   = sink.name;
+        entry.layout = layout;
+    } else if (!tmpfile) {
+        std::cerr << "Error: Cannot find the file of the dataset: " << entry.name << '\n';
+        return false;
+    } else if ((mode == dataset_write_t::replace) && entry.double_buffered) {
+        // Write a shadow file next to the published one, then move it over.
+        sink.name = entry.name;
+        sink.name.replace(sink.name.size() - 6, 6, "XXXXXX");
+        sink.fd = CREATE_TEMP_FILE(&sink.name[0]);
+    } else {
+        // Write after the existing records, or over them.
+        sink.name = entry.name;
+        sink.fd   = this->reopen_tmpfile(*tmpfile, mode == dataset_write_t::append);
+        if ((sink.fd != -1) && (mode == dataset_write_t::replace)) {
+            this->release_bytes(*tmpfile);
+        }
+    }
+    if (sink.fd == -1) {
+        std::cerr << "Error: Cannot open the file of the dataset: " << sink.name << '\n';
+        return false;
+    }
+    return true;
+}
+
+bool Gnuplot::publish_dataset_sink(dataset_entry_t &entry, data_sink_t &sink, bool success)
+{
+    if (sink.name == entry.name) {
+        return success;
+    }
+    // Publish the shadow file, readers see either the old or the new records.
+    tmpfile_t *tmpfile = this->find_tmpfile(entry.name);
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__TOS_WIN__)
+    std::remove(entry.name.c_str());
+#endif
+    if (!success || !tmpfile || (std::rename(sink.name.c_str(), entry.name.c_str()) != 0)) {
+        std::cerr << "Error: Cannot replace the file of the dataset: " << entry.name << '\n';
+        std::remove(sink.name.c_str());
+        session_stats.bytes_stored -= sink.size;
+        Gnuplot::m_stats.bytes_stored -= sink.size;
+        return false;
+    }
+    this->release_bytes(*tmpfile);
+    tmpfile->size = sink.size;
+    return true;
+}
+
+bool Gnuplot::write_dataset_range(dataset_entry_t &entry,
+                                  std::size_t first,
+                                  std::size_t rows,
+                                  const std::string &records)
+{
+    tmpfile_t *tmpfile = this->find_tmpfile(entry.name);
+    if (!tmpfile) {
+        std::cerr << "Error: Cannot find the file of the dataset: " << entry.name << '\n';
+        return false;
+    }
+
+    // Binary records have a fixed size, the new ones are written over the old ones in place.
+    const std::size_t record_size = records.size() / rows;
+    if ((entry.format != data_format_t::text) && !entry.double_buffered) {
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+        const int fd = (tmpfile->fd != -1) ? tmpfile->fd : open(entry.name.c_str(), O_WRONLY | O_CLOEXEC);
+#else
+        const int fd = _open(entry.name.c_str(), _O_WRONLY | _O_BINARY | _O_NOINHERIT);
+#endif
+        const bool success = (fd != -1) && detail::write_at(fd, records.data(), records.size(), first * record_size);
+        if ((fd != -1) && (fd != tmpfile->fd)) {
+            CLOSE_FILE(fd);
+        }
+        if (!success) {
+            std::cerr << "Error: Failed to write data to " << entry.name << '\n';
+            return false;
+        }
+        session_stats.bytes_written += records.size();
+        Gnuplot::m_stats.bytes_written += records.size();
+        return true;
+    }
+
+    // Text lines vary in length, and double buffered files are never
+    // modified in place: the whole file is written again.
+    std::ifstream file(entry.name.c_str(), std::ios::in | std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::size_t begin = first * record_size, end = begin + records.size();
+    if (entry.format == data_format_t::text) {
+        begin = 0;
+        for (std::size_t line = 0; (line < first) && (begin != std::string::npos); ++line) {
+            begin = content.find('\n', begin);
+            begin = (begin == std::string::npos) ? begin : begin + 1;
+        }
+        end = begin;
+        for (std::size_t line = 0; (line < rows) && (end != std::string::npos); ++line) {
+            end = content.find('\n', end);
+            end = (end == std::string::npos) ? end : end + 1;
+        }
+    }
+    if (!file || (begin == std::string::npos) || (end == std::string::npos) || (end > content.size())) {
+        std::cerr << "Error: Cannot read the records of the dataset: " << entry.name << '\n';
+        return false;
+    }
+    content.replace(begin, end - begin, records);
+
+    data_sink_t sink;
+    if (!this->open_dataset_sink(entry, sink, dataset_write_t::replace, entry.layout)) {
+        return false;
+    }
+    sink.buffer.swap(content);
+    const bool success = !this->close_sink(sink).empty();
+    return this->publish_dataset_sink(entry, sink, success);
+}
+
+std::string Gnuplot::style_options()
+{
+    std::ostringstream oss;
+    // Specify the plot style or smoothing option.
+    if (smooth_style == smooth_style_t::none) {
+        oss << " with " << this->plot_style_to_string(plot_style);
+    } else {
+        oss << " smooth " << this->smooth_style_to_string(smooth_style);
+    }
+    // Include line color if it is specified.
+    if (!line_color.empty()) {
+        oss << " lc rgb \"" << line_color << "\"";
+    }
+    // Add line style options only if the plot style supports lines.
+    if (is_line_style(plot_style)) {
+        if (line_width > 0) {
+            oss << " lw " << line_width;
+        }
+        if (!line_style.empty()) {
+            oss << " " << line_style;
+        }
+    }
+    // Add point style and size only if the plot style supports points.
+    if (is_point_style(plot_style)) {
+        oss << " pt " << this->point_style_to_string(point_style);
+        if (point_size > 0) {
+            oss << " ps " << point_size;
+        }
+    }
+    return oss.str();
+}
+
+bool Gnuplot::set_default_tmpfile_directory(const std::string &directory)
+{
+    if (!directory.empty() && !Gnuplot::file_exists(directory, GP_DIRECTORY_ACCESS)) {
+        std::cerr << "Error: Cannot create files inside \"" << directory << "\".\n";
+        return false;
+    }
+    Gnuplot::m_tmpfile_dir = directory;
+    return true;
+}
+
+Gnuplot &Gnuplot::set_tmpfile_directory(const std::string &directory)
+{
+    if (!directory.empty() && !Gnuplot::file_exists(directory, GP_DIRECTORY_ACCESS)) {
+        std::cerr << "Error: Cannot create files inside \"" << directory << "\".\n";
+        return *this;
+    }
+    tmpfile_dir = directory;
+    return *this;
+}
+
+std::string Gnuplot::get_tmpfile_directory() const
+{
+    return !tmpfile_dir.empty() ? tmpfile_dir : Gnuplot::default_tmpfile_directory();
+}
+
+std::string Gnuplot::default_tmpfile_directory()
+{
+    if (!Gnuplot::m_tmpfile_dir.empty()) {
+        return Gnuplot::m_tmpfile_dir;
+    }
+    // Detect the default directory once, it does not change while running.
+    static const std::string detected = Gnuplot::detect_tmpfile_directory();
+    return detected;
+}
+
+bool Gnuplot::set_gnuplot_path(const std::string &path)
+{
+    std::string tmp = path + "/" + Gnuplot::m_gnuplot_filename;
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__TOS_WIN__)
+    if (Gnuplot::file_exists(tmp, 0)) // check existence
+#elif defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    if (Gnuplot::file_exists(tmp, 1)) // check existence and execution permission
+#endif
+    {
+        Gnuplot::m_gnuplot_path = path;
+        return true;
+    } else {
+        Gnuplot::m_gnuplot_path.clear();
+        return false;
+    }
+}
+
+void Gnuplot::set_terminal(terminal_type_t type)
+{
+    // For Unix-like systems, ensure the DISPLAY variable is set when using X11.
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    if ((type == terminal_type_t::x11) && (getenv("DISPLAY") == NULL)) {
+        std::cerr << "Error: Can't find DISPLAY environment variable. Ensure an active X11 session.\n";
+        return;
+    }
+#endif
+
+    // Update the standard terminal type
+    terminal_type = type;
+}
+
+/// Tokenizes a string into a container based on the specified delimiters.
+///
+/// @tparam Container The type of the container to store tokens (e.g., std::vector<std::string>).
+/// @param container Reference to the container where tokens will be stored.
+/// @param in The input string to tokenize.
+/// @param delimiters A string containing delimiter characters (default is whitespace).
+template <typename Container>
+static inline void tokenize(Container &container, const std::string &in, const std::string &delimiters = " \t\n")
+{
+    std::stringstream ss(in);
+    std::string token;
+
+    // Use a custom delimiter iterator if delimiters are more than whitespace.
+    if (delimiters == " \t\n") {
+        while (ss >> token) {
+            container.push_back(token);
+        }
+    } else {
+        std::string::size_type start = 0;
+        while ((start = in.find_first_not_of(delimiters, start)) != std::string::npos) {
+            auto end = in.find_first_of(delimiters, start);
+            container.push_back(in.substr(start, end - start));
+            start = end;
+        }
+    }
+}
+
+Gnuplot &Gnuplot::replot()
+{
+    if (nplots > 0) {
+        this->send_cmd("replot");
+    }
+    return *this;
+}
+
+bool Gnuplot::is_ready() const
+{
+    return valid && gnuplot_pipe;
+}
+
+Gnuplot &Gnuplot::reset_plot()
+{
+    nplots = 0;
+    // Nothing on screen will be replotted, release all the files.
+    this->update_tmpfiles(true);
+    return *this;
+}
+
+Gnuplot &Gnuplot::reset_all()
+{
+    nplots = 0;
+    this->send_cmd("reset");
+    this->send_cmd("clear");
+    plot_style   = plot_style_t::none;
+    smooth_style = smooth_style_t::none;
+    showonscreen();
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_plot_style(plot_style_t style)
+{
+    plot_style = style;
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_smooth_style(smooth_style_t style)
+{
+    smooth_style = style;
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_line_style(line_style_t style, const std::string &custom_pattern)
+{
+    line_style = this->line_style_to_string(style, custom_pattern);
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_line_color(const std::string &color)
+{
+    line_color = color;
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_point_style(point_style_t style)
+{
+    point_style = style;
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_point_size(double size)
+{
+    if (size > 0) {
+        point_size = size;
+    }
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_data_format(data_format_t format)
+{
+    data_format = format;
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_decimation(decimation_t mode, std::size_t size)
+{
+    decimation      = mode;
+    decimation_size = (size > 0) ? size : GP_DECIMATION_SIZE;
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_finite_check(bool enable)
+{
+    finite_check = enable;
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_value_bounds(double lower, double upper)
+{
+    if (lower > upper) {
+        std::cerr << "Error: The lower bound exceeds the upper bound.\n";
+        return *this;
+    }
+    value_lower = lower;
+    value_upper = upper;
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_data_transport(data_transport_t transport)
+{
+    data_transport = transport;
+    fifo_stalled   = false;
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_grid_layout(grid_layout_t layout)
+{
+    grid_layout = layout;
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_tmpfile_pool_size(std::size_t size)
+{
+    tmpfile_pool_size = size;
+    this->trim_tmpfiles();
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_data_cache(bool enable)
+{
+    data_cache = enable;
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_double_buffering(bool enable)
+{
+    double_buffering = enable;
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_tmpfile_quota(std::size_t bytes)
+{
+    tmpfile_quota = bytes;
+    return *this;
+}
+
+storage_stats_t Gnuplot::get_storage_stats() const
+{
+    storage_stats_t stats = session_stats;
+    for (const auto &tmpfile : tmpfile_list) {
+        stats.files += tmpfile.datablock ? 0 : 1;
+    }
+    return stats;
+}
+
+storage_stats_t Gnuplot::get_process_storage_stats()
+{
+    storage_stats_t stats = Gnuplot::m_stats;
+    stats.files           = static_cast<std::size_t>(Gnuplot::m_tmpfile_num);
+    return stats;
+}
+
+std::size_t Gnuplot::get_cache_hits() const
+{
+    return cache_hits;
+}
+
+std::size_t Gnuplot::get_cache_misses() const
+{
+    return cache_misses;
+}
+
+Gnuplot &Gnuplot::set_text_precision(int precision)
+{
+    text_precision = precision;
+    return *this;
+}
+
+Gnuplot &Gnuplot::showonscreen()
+{
+    this->send_cmd("set output");
+    this->send_cmd("set terminal " + this->terminal_type_to_string(terminal_type));
+    return *this;
+}
+
+Gnuplot &Gnuplot::savetofigure(const std::string filename, const std::string terminal)
+{
+    std::ostringstream oss;
+    oss << "set terminal " << terminal;
+    this->send_cmd(oss.str());
+
+    oss.str(""); // Clear oss
+    oss << "set output \"" << filename << "\"";
+    this->send_cmd(oss.str());
+
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_legend(const std::string &position,
+                             const std::string &font,
+                             const std::string &title,
+                             bool with_box,
+                             double spacing,
+                             double width)
+{
+    if (position.empty()) {
+        this->send_cmd("unset key");
+        return *this;
+    }
+
+    std::ostringstream oss;
+
+    // Set the legend position.
+    oss << "set key " << position;
+
+    // Set the legend title, if provided.
+    if (!title.empty()) {
+        oss << " title \"" << title << "\"";
+    }
+
+    // Set the font, if provided.
+    if (!font.empty()) {
+        oss << " font \"" << font << "\"";
+    }
+
+    // Add box around the legend if specified.
+    if (with_box) {
+        oss << " box";
+    } else {
+        oss << " nobox";
+    }
+
+    // Set the spacing between legend items if specified.
+    if (spacing > 0) {
+        oss << " spacing " << spacing;
+    }
+
+    // Set the width of the legend box.
+    if (width > 0) {
+        oss << " width " << width;
+    }
+
+    // Send the command to Gnuplot
+    this->send_cmd(oss.str());
+
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_title(const std::string &title)
+{
+    // Send the command to Gnuplot
+    this->send_cmd("set title \"" + title + "\"");
+    return *this;
+}
+
+Gnuplot &Gnuplot::unset_title()
+{
+    this->set_title();
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_xlogscale(const double base)
+{
+    std::ostringstream cmdstr;
+
+    cmdstr << "set logscale x " << base;
+    this->send_cmd(cmdstr.str());
+
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_ylogscale(const double base)
+{
+    std::ostringstream cmdstr;
+
+    cmdstr << "set logscale y " << base;
+    this->send_cmd(cmdstr.str());
+
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_zlogscale(const double base)
+{
+    std::ostringstream cmdstr;
+
+    cmdstr << "set logscale z " << base;
+    this->send_cmd(cmdstr.str());
+
+    return *this;
+}
+
+Gnuplot &Gnuplot::unset_xlogscale()
+{
+    this->send_cmd("unset logscale x");
+    return *this;
+}
+
+Gnuplot &Gnuplot::unset_ylogscale()
+{
+    this->send_cmd("unset logscale y");
+    return *this;
+}
+
+Gnuplot &Gnuplot::unset_zlogscale()
+{
+    this->send_cmd("unset logscale z");
+    return *this;
+}
+
+Gnuplot &Gnuplot::set_line_width(double width)
+{
+    if (width > 0) {
+        line_width = width;
+    }
+    return *this;
+}
+
+/// turns grid on/off
+Gnuplot &Gnuplot::set_grid()
+{
+    this->send_cmd("set grid");
+    return *this;
+};
+
+/// grid is not set by default
+Gnuplot &Gnuplot::unset_grid()
+{
+    this->send_cmd("unset grid");
+    return *this;
+};
+
+Gnuplot &Gnuplot::set_multiplot()
+{
+    this->send_cmd("set multiplot");
+    return *this;
+};
+
+Gnuplot &Gnuplot::unset_multiplot()
+{
+    this->send_cmd("unset multiplot");
     return *this;
-}
+};
 
-bool Gnuplot::set_gnuplot_path(const std::string &path)
+Gnuplot &Gnuplot::set_samples(const int samples)
 {
-    std::string tmp = path + "/" + Gnuplot::m_gnuplot_filename;
+    std::ostringstream cmdstr;
+    cmdstr << "set samples " << samples;
+    this->send_cmd(cmdstr.str());
 
-#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__TOS_WIN__)
-    if (Gnuplot::file_exists(tmp, 0)) // check existence
-#elif defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
-    if (Gnuplot::file_exists(tmp, 1)) // check existence and execution permission
-#endif
-    {
-        Gnuplot::m_gnuplot_path = path;
-        return true;
-    } else {
-        Gnuplot::m_gnuplot_path.clear();
-        return false;
-    }
+    return *this;
 }
 
-void Gnuplot::set_terminal(terminal_type_t type)
+Gnuplot &Gnuplot::set_isosamples(const int isolines)
 {
-    // For Unix-like systems, ensure the DISPLAY variable is set when using X11.
-#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
-    if ((type == terminal_type_t::x11) && (getenv("DISPLAY") == NULL)) {
-        std::cerr << "Error: Can't find DISPLAY environment variable. Ensure an active X11 session.\n";
-        return;
-    }
-#endif
+    std::ostringstream cmdstr;
+    cmdstr << "set isosamples " << isolines;
+    this->send_cmd(cmdstr.str());
 
-    // Update the standard terminal type
-    terminal_type = type;
+    return *this;
 }
 
-/// Tokenizes a string into a container based on the specified delimiters.
-///
-/// @tparam Container The type of the container to store tokens (e.g., std::vector<std::string>).
-/// @param container Reference to the container where tokens will be stored.
-/// @param in The input string to tokenize.
-/// @param delimiters A string containing delimiter characters (default is whitespace).
-template <typename Container>
-static inline void tokenize(Container &container, const std::string &in, const std::string &delimiters = " \t\n")
+Gnuplot &Gnuplot::set_contour_type(contour_type_t type)
 {
-    std::stringstream ss(in);
-    std::string token;
+    contour.type = type;
+    return *this;
+}
 
-    // Use a custom delimiter iterator if delimiters are more than whitespace.
-    if (delimiters == " \t\n") {
-        while (ss >> token) {
-            container.push_back(token);
-        }
-    } else {
-        std::string::size_type start = 0;
-        while ((start = in.find_first_not_of(delimiters, start)) != std::string::npos) {
-            auto end = in.find_first_of(delimiters, start);
-            container.push_back(in.substr(start, end - start));
-            start = end;
-        }
-    }
+Gnuplot &Gnuplot::set_contour_param(contour_param_t param)
+{
+    contour.param = param;
+    return *this;
 }
 
-Gnuplot &Gnuplot::replot()
+Gnuplot &Gnuplot::set_contour_levels(int levels)
 {
-    if (nplots > 0) {
-        this->send_cmd("replot");
+    if (levels > 0) {
+        contour.levels = levels;
     }
     return *this;
 }
 
-bool Gnuplot::is_ready() const
+Gnuplot &Gnuplot::set_contour_increment(double start, double step, double end)
 {
-    return valid && gnuplot_pipe;
+    contour.increment_start = start;
+    contour.increment_step  = step;
+    contour.increment_end   = end;
+    return *this;
 }
 
-Gnuplot &Gnuplot::reset_plot()
+Gnuplot &Gnuplot::set_contour_discrete_levels(const std::vector<double> &levels)
 {
-    nplots = 0;
+    contour.discrete_levels = levels;
     return *this;
 }
 
-Gnuplot &Gnuplot::reset_all()
+Gnuplot &Gnuplot::set_hidden3d()
 {
-    nplots = 0;
-    this->send_cmd("reset");
-    this->send_cmd("clear");
-    plot_style   = plot_style_t::none;
-    smooth_style = smooth_style_t::none;
-    showonscreen();
+    this->send_cmd("set hidden3d");
     return *this;
-}
+};
 
-Gnuplot &Gnuplot::set_plot_style(plot_style_t style)
+Gnuplot &Gnuplot::unset_hidden3d()
 {
-    plot_style = style;
+    this->send_cmd("unset hidden3d");
     return *this;
-}
+};
 
-Gnuplot &Gnuplot::set_smooth_style(smooth_style_t style)
+Gnuplot &Gnuplot::unset_contour()
 {
-    smooth_style = style;
+    this->send_cmd("unset contour");
+    return *this;
+};
+
+Gnuplot &Gnuplot::set_surface()
+{
+    this->send_cmd("set surface");
+    return *this;
+};
+
+Gnuplot &Gnuplot::unset_surface()
+{
+    this->send_cmd("unset surface");
     return *this;
 }
 
-Gnuplot &Gnuplot::set_line_style(line_style_t style, const std::string &custom_pattern)
+Gnuplot &Gnuplot::set_xautoscale()
 {
-    line_style = this->line_style_to_string(style, custom_pattern);
+    this->send_cmd("set xrange restore");
+    this->send_cmd("set autoscale x");
+    return *this;
+};
+
+Gnuplot &Gnuplot::set_yautoscale()
+{
+    this->send_cmd("set yrange restore");
+    this->send_cmd("set autoscale y");
+    return *this;
+};
+
+Gnuplot &Gnuplot::set_zautoscale()
+{
+    this->send_cmd("set zrange restore");
+    this->send_cmd("set autoscale z");
+    return *this;
+};
+
+Gnuplot &Gnuplot::set_xlabel(const std::string &label)
+{
+    std::ostringstream cmdstr;
+
+    cmdstr << "set xlabel \"" << label << "\"";
+    this->send_cmd(cmdstr.str());
+
     return *this;
 }
 
-Gnuplot &Gnuplot::set_line_color(const std::string &color)
+Gnuplot &Gnuplot::set_ylabel(const std::string &label)
 {
-    line_color = color;
+    std::ostringstream cmdstr;
+
+    cmdstr << "set ylabel \"" << label << "\"";
+    this->send_cmd(cmdstr.str());
+
     return *this;
 }
 
-Gnuplot &Gnuplot::set_point_style(point_style_t style)
+Gnuplot &Gnuplot::set_zlabel(const std::string &label)
 {
-    point_style = style;
+    std::ostringstream cmdstr;
+
+    cmdstr << "set zlabel \"" << label << "\"";
+    this->send_cmd(cmdstr.str());
+
     return *this;
 }
 
-Gnuplot &Gnuplot::set_point_size(double size)
+Gnuplot &Gnuplot::set_xrange(const double iFrom, const double iTo)
 {
-    if (size > 0) {
-        point_size = size;
-    }
+    std::ostringstream cmdstr;
+
+    cmdstr << "set xrange[" << iFrom << ":" << iTo << "]";
+    this->send_cmd(cmdstr.str());
+
     return *this;
 }
 
-Gnuplot &Gnuplot::showonscreen()
+Gnuplot &Gnuplot::set_yrange(const double iFrom, const double iTo)
 {
-    this->send_cmd("set output");
-    this->send_cmd("set terminal " + this->terminal_type_to_string(terminal_type));
+    std::ostringstream cmdstr;
+
+    cmdstr << "set yrange[" << iFrom << ":" << iTo << "]";
+    this->send_cmd(cmdstr.str());
+
     return *this;
 }
 
-Gnuplot &Gnuplot::savetofigure(const std::string filename, const std::string terminal)
+Gnuplot &Gnuplot::set_zrange(const double iFrom, const double iTo)
 {
-    std::ostringstream oss;
-    oss << "set terminal " << terminal;
-    this->send_cmd(oss.str());
+    std::ostringstream cmdstr;
 
-    oss.str(""); // Clear oss
-    oss << "set output \"" << filename << "\"";
-    this->send_cmd(oss.str());
+    cmdstr << "set zrange[" << iFrom << ":" << iTo << "]";
+    this->send_cmd(cmdstr.str());
 
     return *this;
 }
 
-Gnuplot &Gnuplot::set_legend(const std::string &position,
-                             const std::string &font,
-                             const std::string &title,
-                             bool with_box,
-                             double spacing,
-                             double width)
+Gnuplot &Gnuplot::set_cbrange(const double iFrom, const double iTo)
 {
-    if (position.empty()) {
-        this->send_cmd("unset key");
-        return *this;
-    }
+    std::ostringstream cmdstr;
 
-    std::ostringstream oss;
+    cmdstr << "set cbrange[" << iFrom << ":" << iTo << "]";
+    this->send_cmd(cmdstr.str());
 
-    // Set the legend position.
-    oss << "set key " << position;
+    return *this;
+}
 
-    // Set the legend title, if provided.
-    if (!title.empty()) {
-        oss << " title \"" << title << "\"";
+bool Gnuplot::get_program_path()
+{
+    // Check the first location: `m_gnuplot_path`
+    std::string tmp = Gnuplot::m_gnuplot_path + "/" + Gnuplot::m_gnuplot_filename;
+
+    if (Gnuplot::file_exists(tmp, 1)) { // Check for existence and execution permission
+        return true;
     }
 
-    // Set the font, if provided.
-    if (!font.empty()) {
-        oss << " font \"" << font << "\"";
+    // Check the second location: System PATH
+    char *path = getenv("PATH");
+    if (path == nullptr) {
+        std::cerr << "Error: PATH environment variable is not set.\n";
+        return false;
     }
 
-    // Add box around the legend if specified.
-    if (with_box) {
-        oss << " box";
-    } else {
-        oss << " nobox";
+    // Tokenize the PATH variable into directories
+    std::list<std::string> paths;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__TOS_WIN__)
+    tokenize(paths, path, ";");
+#elif defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    tokenize(paths, path, ":");
+#endif
+
+    // Search for the Gnuplot executable in each directory
+    for (const auto &dir : paths) {
+        tmp = dir + "/" + Gnuplot::m_gnuplot_filename;
+        if (Gnuplot::file_exists(tmp, 1)) { // Check for existence and execution permission
+            Gnuplot::m_gnuplot_path = dir;  // Set `m_gnuplot_path`
+            return true;
+        }
     }
 
-    // Set the spacing between legend items if specified.
-    if (spacing > 0) {
-        oss << " spacing " << spacing;
+    // Gnuplot was not found
+    std::cerr << "Error: Gnuplot not found in PATH or in \"" << Gnuplot::m_gnuplot_path << "\".\n";
+    return false;
+}
+
+bool Gnuplot::file_exists(const std::string &filename, int mode)
+{
+    // Validate mode argument
+    if (mode < 0 || mode > 7) {
+        std::cerr << "Error: Invalid mode in Gnuplot::file_exists. Mode must be between 0 and 7.\n";
+        return false;
     }
 
-    // Set the width of the legend box.
-    if (width > 0) {
-        oss << " width " << width;
+    // Check file access using platform-independent macro
+    // mode = 0: Existence, 1: Execute, 2: Write, 4: Read
+    if (FILE_ACCESS(filename.c_str(), mode) == 0) {
+        return true; // File exists with the required mode
     }
 
-    // Send the command to Gnuplot
-    this->send_cmd(oss.str());
-
-    return *this;
+    // File does not exist or is inaccessible
+    return false;
 }
 
-Gnuplot &Gnuplot::set_title(const std::string &title)
+bool Gnuplot::is_line_style(plot_style_t style)
 {
-    // Send the command to Gnuplot
-    this->send_cmd("set title \"" + title + "\"");
-    return *this;
+    return (style == plot_style_t::lines || style == plot_style_t::lines_points || style == plot_style_t::steps ||
+            style == plot_style_t::fsteps || style == plot_style_t::histeps || style == plot_style_t::filled_curves ||
+            style == plot_style_t::impulses);
 }
 
-Gnuplot &Gnuplot::unset_title()
+bool Gnuplot::is_point_style(plot_style_t style)
 {
-    this->set_title();
-    return *this;
+    return (style == plot_style_t::points || style == plot_style_t::lines_points);
 }
 
-Gnuplot &Gnuplot::set_xlogscale(const double base)
+std::string Gnuplot::detect_tmpfile_directory()
 {
-    std::ostringstream cmdstr;
-
-    cmdstr << "set logscale x " << base;
-    this->send_cmd(cmdstr.str());
-
-    return *this;
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    // An explicit TMPDIR always wins.
+    const char *tmpdir = getenv("TMPDIR");
+    if (tmpdir && *tmpdir && Gnuplot::file_exists(tmpdir, GP_DIRECTORY_ACCESS)) {
+        return tmpdir;
+    }
+#if defined(__linux__)
+    // Otherwise prefer a memory-backed filesystem.
+    const char *candidates[] = { "/dev/shm", getenv("XDG_RUNTIME_DIR") };
+    for (const char *candidate : candidates) {
+        struct statfs info;
+        if (candidate && *candidate && Gnuplot::file_exists(candidate, GP_DIRECTORY_ACCESS) &&
+            (statfs(candidate, &info) == 0) &&
+            ((info.f_type == 0x01021994) || (info.f_type == static_cast<decltype(info.f_type)>(0x858458f6)))) {
+            return candidate; // TMPFS_MAGIC or RAMFS_MAGIC
+        }
+    }
+#endif
+    return "/tmp";
+#else
+    return std::string(); // The working directory
+#endif
 }
 
-Gnuplot &Gnuplot::set_ylogscale(const double base)
+std::string Gnuplot::tmpfile_template() const
 {
-    std::ostringstream cmdstr;
-
-    cmdstr << "set logscale y " << base;
-    this->send_cmd(cmdstr.str());
-
-    return *this;
+    std::string directory = this->get_tmpfile_directory();
+    if (!directory.empty() && (directory.back() != '/')) {
+        directory += '/';
+    }
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    // The owner is part of the name, to recognize the files of crashed processes.
+    return directory + "gnuploti" + Gnuplot::process_tag() + "-" + std::to_string(getpid()) + "-XXXXXX";
+#else
+    return directory + "gnuplotiXXXXXX";
+#endif
 }
 
-Gnuplot &Gnuplot::set_zlogscale(const double base)
+std::string Gnuplot::process_tag()
 {
-    std::ostringstream cmdstr;
-
-    cmdstr << "set logscale z " << base;
-    this->send_cmd(cmdstr.str());
-
-    return *this;
+    static const std::string tag = []() {
+#if defined(__linux__)
+        // A PID only designates a process inside its PID namespace, during the current boot.
+        std::string identity;
+        std::ifstream boot_id("/proc/sys/kernel/random/boot_id");
+        struct stat ns;
+        if (!std::getline(boot_id, identity) || identity.empty() || (stat("/proc/self/ns/pid", &ns) != 0)) {
+            return std::string();
+        }
+        identity += ":" + std::to_string(ns.st_dev) + ":" + std::to_string(ns.st_ino);
+        detail::hasher_t hasher;
+        hasher.update(identity.data(), identity.size());
+        char text[17];
+        snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hasher.digest()));
+        return std::string(text);
+#else
+        return std::string();
+#endif
+    }();
+    return tag;
 }
 
-Gnuplot &Gnuplot::unset_xlogscale()
+void Gnuplot::set_orphan_sweep(bool enable)
 {
-    this->send_cmd("unset logscale x");
-    return *this;
+    Gnuplot::m_sweep_orphans = enable;
 }
 
-Gnuplot &Gnuplot::unset_ylogscale()
+std::size_t Gnuplot::sweep_orphaned_tmpfiles()
 {
-    this->send_cmd("unset logscale y");
-    return *this;
+    std::size_t removed = 0;
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    // PIDs of other boots or namespaces cannot be checked, without a tag they cannot be told apart.
+    const std::string tag = Gnuplot::process_tag();
+    if (tag.empty()) {
+        return 0;
+    }
+    const std::string prefix    = "gnuploti" + tag + "-";
+    const std::string directory = Gnuplot::default_tmpfile_directory();
+    DIR *dir                    = opendir(directory.c_str());
+    if (!dir) {
+        return 0;
+    }
+    // Collect the files named "gnuploti<tag>-<pid>-XXXXXX" whose process is gone.
+    std::vector<std::string> orphans;
+    while (const struct dirent *entry = readdir(dir)) {
+        const char *name = entry->d_name;
+        if (std::strncmp(name, prefix.c_str(), prefix.size()) != 0) {
+            continue;
+        }
+        const char *digits = name + prefix.size();
+        char *end          = nullptr;
+        const long pid     = std::strtol(digits, &end, 10);
+        const bool dead    = (pid > 0) && (end != digits) && (*end == '-') && (pid != getpid()) &&
+                             (kill(static_cast<pid_t>(pid), 0) == -1) && (errno == ESRCH);
+        if (dead) {
+            orphans.push_back(directory + "/" + name);
+        }
+    }
+    closedir(dir);
+    for (const std::string &orphan : orphans) {
+        removed += (unlink(orphan.c_str()) == 0) ? 1 : 0;
+    }
+#endif
+    return removed;
 }
 
-Gnuplot &Gnuplot::unset_zlogscale()
+int Gnuplot::reopen_tmpfile(const tmpfile_t &tmpfile, bool append)
 {
-    this->send_cmd("unset logscale z");
-    return *this;
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    // Anonymous files are written through the descriptor keeping them alive.
+    if (tmpfile.fd != -1) {
+        if (!append && (ftruncate(tmpfile.fd, 0) != 0)) {
+            return -1;
+        }
+        return (lseek(tmpfile.fd, 0, append ? SEEK_END : SEEK_SET) == -1) ? -1 : tmpfile.fd;
+    }
+    return open(tmpfile.name.c_str(), O_WRONLY | O_CLOEXEC | (append ? O_APPEND : O_TRUNC));
+#else
+    return _open(tmpfile.name.c_str(), _O_WRONLY | _O_BINARY | _O_NOINHERIT | (append ? _O_APPEND : _O_TRUNC));
+#endif
 }
 
-Gnuplot &Gnuplot::set_line_width(double width)
+std::string Gnuplot::create_tmpfile(int &fd, bool named)
 {
-    if (width > 0) {
-        line_width = width;
+    // Recycle the least recently used file which no plot reads anymore, if
+    // Gnuplot is done with it; otherwise create a new one instead of waiting.
+    tmpfile_t *recycled = this->find_unused_tmpfile(named);
+    if (recycled) {
+        fd = this->reopen_tmpfile(*recycled, false);
+        if (fd != -1) {
+            this->release_bytes(*recycled);
+            recycled->pending  = 1;
+            recycled->cached   = false;
+            recycled->last_use = ++tmpfile_clock;
+            recycled->source.clear();
+            return recycled->name;
+        }
+        std::cerr << "Warning: Cannot recycle temporary file \"" << recycled->name << "\".\n";
     }
-    return *this;
-}
 
-/// turns grid on/off
-Gnuplot &Gnuplot::set_grid()
-{
-    this->send_cmd("set grid");
-    return *this;
-};
+    std::string filename;
+    int anonymous = -1;
+#if defined(GP_USE_MEMFD)
+    if (!named) {
+        // Create an anonymous memory file, Gnuplot reaches it through our /proc entry.
+        fd = anonymous = memfd_create("gnuploti", MFD_CLOEXEC);
+        if (fd == -1) {
+            std::cerr << "Error: Cannot create anonymous temporary file.\n";
+            return std::string(); // Return an empty string to indicate failure
+        }
+        filename = "/proc/" + std::to_string(getpid()) + "/fd/" + std::to_string(fd);
+    }
+#endif
+    if (anonymous == -1) {
+        filename = this->tmpfile_template();
+
+        // Generate a unique temporary file, and keep it open for writing.
+        fd = CREATE_TEMP_FILE(&filename[0]);
+        if (fd == -1) {
+            std::cerr << "Error: Cannot create temporary file \"" << filename << "\".\n";
+            return std::string(); // Return an empty string to indicate failure
+        }
+    }
 
-/// grid is not set by default
-Gnuplot &Gnuplot::unset_grid()
-{
-    this->send_cmd("unset grid");
-    return *this;
-};
+    // Store the temporary file for cleanup and increment the counter.
+    tmpfile_list.push_back(
+        tmpfile_t{ filename, anonymous, false, 1, 0, 0, ++tmpfile_clock, 0, false, 0, std::string() });
+    Gnuplot::m_tmpfile_num++;
 
-Gnuplot &Gnuplot::set_multiplot()
-{
-    this->send_cmd("set multiplot");
-    return *this;
-};
+    return filename; // Return the name of the successfully created temporary file
+}
 
-Gnuplot &Gnuplot::unset_multiplot()
+bool Gnuplot::open_sink(data_sink_t &sink, data_transport_t transport, bool named)
 {
-    this->send_cmd("unset multiplot");
-    return *this;
-};
+    sink.buffer.clear();
+    sink.chunks.clear();
+    sink.fd        = -1;
+    sink.size      = 0;
+    sink.transport = transport;
+
+    if (transport == data_transport_t::datablock) {
+        // Check if the Gnuplot session is ready.
+        if (!this->is_ready()) {
+            std::cerr << "Error: Invalid Gnuplot session not ready.\n";
+            return false;
+        }
+        // Give the datablock a unique name, and start its definition.
+        sink.name = "$gnuplot_data" + std::to_string(++ndatablocks);
+        fprintf(gnuplot_pipe, "%s << EOD\n", sink.name.c_str());
+        // Track its references like those of a file, to undefine it once unreachable.
+        tmpfile_list.push_back(tmpfile_t{ sink.name, -1, true, 1, 0, 0, ++tmpfile_clock, 0, false, 0, std::string() });
+        return true;
+    }
 
-Gnuplot &Gnuplot::set_samples(const int samples)
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    if (transport == data_transport_t::fifo) {
+        // Reserve a unique name, and replace the file with a named pipe.
+        std::string filename = this->tmpfile_template();
+        int fd               = CREATE_TEMP_FILE(&filename[0]);
+        if (fd == -1) {
+            std::cerr << "Error: Cannot create a name for the named pipe.\n";
+            return false;
+        }
+        close(fd);
+        std::remove(filename.c_str());
+        if (mkfifo(filename.c_str(), 0600) != 0) {
+            std::cerr << "Error: Cannot create named pipe \"" << filename << "\".\n";
+            return false;
+        }
+        sink.name = filename;
+        return true;
+    }
+#else
+    if (transport == data_transport_t::fifo) {
+        sink.transport = data_transport_t::file;
+    }
+#endif
+
+    // Create a temporary file for storing the data.
+    sink.name = this->create_tmpfile(sink.fd, named);
+    if (sink.name.empty()) {
+        std::cerr << "Error: Failed to create a temporary file.\n";
+        return false;
+    }
+    return true;
+}
+
+bool Gnuplot::write_sink(data_sink_t &sink, const char *data, std::size_t size)
 {
-    std::ostringstream cmdstr;
-    cmdstr << "set samples " << samples;
-    this->send_cmd(cmdstr.str());
+    if (sink.transport == data_transport_t::datablock) {
+        if (fwrite(data, 1, size, gnuplot_pipe) != size) {
+            std::cerr << "Error: Failed to send datablock " << sink.name << " to Gnuplot.\n";
+            return false;
+        }
+        return true;
+    }
 
-    return *this;
+    // Keep the order of the data, queued buffers go first.
+    if (!this->write_chunks(sink)) {
+        return false;
+    }
+    if ((sink.fd == -1) && !this->connect_fifo(sink)) {
+        return false;
+    }
+    if (!this->account_bytes(sink, size)) {
+        return false;
+    }
+    if (!detail::write_all(sink.fd, data, size)) {
+        std::cerr << "Error: Failed to write data to " << sink.name << '\n';
+        return false;
+    }
+    return true;
 }
 
-Gnuplot &Gnuplot::set_isosamples(const int isolines)
+bool Gnuplot::flush_sink(data_sink_t &sink)
 {
-    std::ostringstream cmdstr;
-    cmdstr << "set isosamples " << isolines;
-    this->send_cmd(cmdstr.str());
+    if (sink.buffer.empty()) {
+        return true;
+    }
+    if (sink.transport == data_transport_t::datablock) {
+        const bool success = this->write_sink(sink, sink.buffer.data(), sink.buffer.size());
+        sink.buffer.clear();
+        return success;
+    }
 
-    return *this;
+    // Queue the full buffer, and continue serializing inside a fresh one.
+    sink.chunks.push_back(std::string());
+    sink.chunks.back().swap(sink.buffer);
+    if (sink.chunks.size() < GP_WRITE_VECTOR_SIZE) {
+        sink.buffer.reserve(GP_WRITE_BUFFER_SIZE);
+        return true;
+    }
+    return this->write_chunks(sink);
 }
 
-Gnuplot &Gnuplot::set_contour_type(contour_type_t type)
+bool Gnuplot::write_chunks(data_sink_t &sink)
 {
-    contour.type = type;
-    return *this;
+    if (sink.chunks.empty()) {
+        return true;
+    }
+    std::size_t size = 0;
+    for (const std::string &chunk : sink.chunks) {
+        size += chunk.size();
+    }
+    bool success = ((sink.fd != -1) || this->connect_fifo(sink)) && this->account_bytes(sink, size);
+    if (success && !detail::write_vectored(sink.fd, sink.chunks)) {
+        std::cerr << "Error: Failed to write data to " << sink.name << '\n';
+        success = false;
+    }
+    // Recycle the storage of one of the buffers.
+    if (sink.buffer.empty()) {
+        sink.buffer.swap(sink.chunks.front());
+        sink.buffer.clear();
+    }
+    sink.chunks.clear();
+    return success;
 }
 
-Gnuplot &Gnuplot::set_contour_param(contour_param_t param)
+bool Gnuplot::account_bytes(data_sink_t &sink, std::size_t size)
 {
-    contour.param = param;
-    return *this;
+    // Only files take space, named pipes and datablocks are consumed by Gnuplot.
+    if (sink.transport != data_transport_t::file) {
+        return true;
+    }
+    tmpfile_t *tmpfile = this->find_tmpfile(sink.name);
+    if (tmpfile_quota > 0) {
+        // Make room by deleting the files which no plot reads, least recently
+        // used first, waiting for Gnuplot to be done with them if needed.
+        while (session_stats.bytes_stored + size > tmpfile_quota) {
+            tmpfile_t *evicted = this->find_unused_tmpfile(false, true);
+            if (!evicted) {
+                std::cerr << "Error: Writing " << sink.name << " exceeds the quota of " << tmpfile_quota
+                          << " bytes of temporary files.\n";
+                return false;
+            }
+            this->release_bytes(*evicted);
+            detail::delete_tmpfile(evicted->name, evicted->fd);
+            Gnuplot::m_tmpfile_num--;
+            tmpfile_list.erase(tmpfile_list.begin() + (evicted - tmpfile_list.data()));
+            tmpfile = this->find_tmpfile(sink.name);
+        }
+    }
+    if (tmpfile) {
+        tmpfile->size += size;
+    }
+    sink.size += size;
+    session_stats.bytes_written += size;
+    session_stats.bytes_stored += size;
+    Gnuplot::m_stats.bytes_written += size;
+    Gnuplot::m_stats.bytes_stored += size;
+    return true;
 }
 
-Gnuplot &Gnuplot::set_contour_levels(int levels)
+Gnuplot::tmpfile_t *Gnuplot::find_unused_tmpfile(bool named, bool sync)
 {
-    if (levels > 0) {
-        contour.levels = levels;
+    tmpfile_t *unused = nullptr;
+    bool unsettled    = false;
+    for (auto &tmpfile : tmpfile_list) {
+        if (tmpfile.datablock || tmpfile.used() || (named && (tmpfile.fd != -1))) {
+            continue;
+        }
+        if (!this->is_settled(tmpfile)) {
+            unsettled = true;
+        } else if (!unused || (tmpfile.last_use < unused->last_use)) {
+            unused = &tmpfile;
+        }
     }
-    return *this;
+    if (!unused && unsettled && sync && this->sync_tmpfiles(true)) {
+        return this->find_unused_tmpfile(named, false);
+    }
+    return unused;
 }
 
-Gnuplot &Gnuplot::set_contour_increment(double start, double step, double end)
+bool Gnuplot::is_settled(const tmpfile_t &tmpfile) const
 {
-    contour.increment_start = start;
-    contour.increment_step  = step;
-    contour.increment_end   = end;
-    return *this;
+    return !tmpfile.used() && (tmpfile.last_use <= tmpfile_synced);
 }
 
-Gnuplot &Gnuplot::set_contour_discrete_levels(const std::vector<double> &levels)
+bool Gnuplot::sync_tmpfiles(bool wait)
 {
-    contour.discrete_levels = levels;
-    return *this;
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    // Gnuplot executes its commands in order, once it has written the marker
+    // requested here it no longer reads the files released before. Neither
+    // side ever waits for the other, and a marker Gnuplot has not written yet
+    // stays pending for the next check.
+    if (sync_marker.empty()) {
+        if (!this->is_ready()) {
+            return false;
+        }
+        std::string filename = this->tmpfile_template();
+        const int fd         = CREATE_TEMP_FILE(&filename[0]);
+        if (fd == -1) {
+            std::cerr << "Error: Cannot create the marker of the temporary files.\n";
+            return false;
+        }
+        close(fd);
+        fprintf(gnuplot_pipe, "save terminal \"%s\"\n", filename.c_str());
+        fflush(gnuplot_pipe);
+        sync_marker = filename;
+        sync_clock  = tmpfile_clock;
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(wait ? GP_FIFO_TIMEOUT_MS : 0);
+    struct stat info;
+    while ((stat(sync_marker.c_str(), &info) == 0) && (info.st_size == 0)) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        usleep(1000);
+    }
+    std::remove(sync_marker.c_str());
+    sync_marker.clear();
+    tmpfile_synced = sync_clock;
+#else
+    // Without named pipes, the files released by a plot are assumed read once
+    // the next new plot is sent.
+    (void)wait;
+    tmpfile_synced = fresh_clock;
+#endif
+    return true;
 }
 
-Gnuplot &Gnuplot::set_hidden3d()
+void Gnuplot::release_bytes(tmpfile_t &tmpfile)
 {
-    this->send_cmd("set hidden3d");
-    return *this;
-};
+    session_stats.bytes_stored -= tmpfile.size;
+    Gnuplot::m_stats.bytes_stored -= tmpfile.size;
+    tmpfile.size = 0;
+}
 
-Gnuplot &Gnuplot::unset_hidden3d()
+Gnuplot::tmpfile_t *Gnuplot::find_tmpfile(const std::string &name)
 {
-    this->send_cmd("unset hidden3d");
-    return *this;
-};
+    for (auto &tmpfile : tmpfile_list) {
+        if (tmpfile.name == name) {
+            return &tmpfile;
+        }
+    }
+    return nullptr;
+}
 
-Gnuplot &Gnuplot::unset_contour()
+bool Gnuplot::connect_fifo(data_sink_t &sink)
 {
-    this->send_cmd("unset contour");
-    return *this;
-};
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    if (sink.transport == data_transport_t::fifo) {
+        // Wait for Gnuplot to open the pipe, opening it without a reader would block forever.
+        while (sink.fd == -1) {
+            sink.fd = open(sink.name.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+            if ((sink.fd != -1) || (errno != ENXIO) || (std::chrono::steady_clock::now() >= sink.deadline)) {
+                break;
+            }
+            usleep(1000);
+        }
+        if (sink.fd == -1) {
+            std::cerr << "Error: Gnuplot did not open the named pipe \"" << sink.name
+                      << "\", the following plots use temporary files.\n";
+            fifo_stalled = true;
+            return false;
+        }
+        // Gnuplot is reading, from now on let writes wait for it.
+        fcntl(sink.fd, F_SETFL, fcntl(sink.fd, F_GETFL) & ~O_NONBLOCK);
+        return true;
+    }
+#endif
+    std::cerr << "Error: The destination " << sink.name << " is not open.\n";
+    return false;
+}
 
-Gnuplot &Gnuplot::set_surface()
+void Gnuplot::discard_pending()
 {
-    this->send_cmd("set surface");
-    return *this;
-};
+    for (const auto &write : pending_writes) {
+        this->release_fifo(write.name);
+    }
+    pending_writes.clear();
+
+    // No command will read the files written for the plot, let them be recycled.
+    bool released = false;
+    for (auto &tmpfile : tmpfile_list) {
+        if (tmpfile.pending > 0) {
+            tmpfile.pending = 0;
+            if (!tmpfile.used()) {
+                tmpfile.last_use = ++tmpfile_clock;
+                released         = true;
+            }
+        }
+    }
+    if (released) {
+        this->trim_tmpfiles();
+    }
+}
 
-Gnuplot &Gnuplot::unset_surface()
+void Gnuplot::release_fifo(const std::string &name)
 {
-    this->send_cmd("unset surface");
-    return *this;
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    // Hold a write end, which opening for reading and writing gives without
+    // waiting for a reader, while the name is removed: Gnuplot either opened
+    // the pipe before and reads an empty content once it is closed, or fails
+    // to open it afterwards, but never waits for a writer forever.
+    const int fd = open(name.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    std::remove(name.c_str());
+    if (fd != -1) {
+        close(fd);
+    }
+#else
+    std::remove(name.c_str());
+#endif
 }
 
-Gnuplot &Gnuplot::set_xautoscale()
+std::string Gnuplot::close_sink(data_sink_t &sink)
 {
-    this->send_cmd("set xrange restore");
-    this->send_cmd("set autoscale x");
-    return *this;
-};
+    if (sink.transport == data_transport_t::datablock) {
+        const bool success = this->flush_sink(sink);
+        // Terminate the datablock, even after a failure, to keep the session usable.
+        fprintf(gnuplot_pipe, "EOD\n");
+        fflush(gnuplot_pipe);
+        return success ? sink.name : std::string();
+    }
 
-Gnuplot &Gnuplot::set_yautoscale()
-{
-    this->send_cmd("set yrange restore");
-    this->send_cmd("set autoscale y");
-    return *this;
-};
+    // Write everything left with a single vectored write.
+    if (!sink.buffer.empty()) {
+        sink.chunks.push_back(std::string());
+        sink.chunks.back().swap(sink.buffer);
+    }
+    const bool success = this->write_chunks(sink);
 
-Gnuplot &Gnuplot::set_zautoscale()
+#if defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
+    if (sink.transport == data_transport_t::fifo) {
+        // Closing the pipe signals the end of the data. The pipe is removed
+        // right away, its content cannot be read a second time anyway.
+        if (sink.fd != -1) {
+            close(sink.fd);
+            sink.fd = -1;
+        }
+        std::remove(sink.name.c_str());
+        return success ? "\"" + sink.name + "\"" : std::string();
+    }
+#endif
+
+    // Regular files are complete, anonymous files live as long as their descriptor.
+    tmpfile_t *tmpfile = this->find_tmpfile(sink.name);
+    if ((sink.fd != -1) && (!tmpfile || (tmpfile->fd != sink.fd))) {
+        CLOSE_FILE(sink.fd);
+    }
+    sink.fd = -1;
+    if (!success) {
+        // No command will read the incomplete file, let it be recycled.
+        if (tmpfile && (tmpfile->pending > 0)) {
+            tmpfile->pending--;
+        }
+        return std::string();
+    }
+    return "\"" + sink.name + "\"";
+}
+
+template <typename... Columns>
+bool Gnuplot::write_records(data_sink_t &sink,
+                            data_format_t format,
+                            const detail::quantization_t *quantization,
+                            std::size_t rows,
+                            const Columns &...columns)
 {
-    this->send_cmd("set zrange restore");
-    this->send_cmd("set autoscale z");
-    return *this;
-};
+    // Serialize the records inside a buffer, and write it in large blocks.
+    sink.buffer.reserve(GP_WRITE_BUFFER_SIZE);
+    for (std::size_t i = 0; i < rows; ++i) {
+        if (format == data_format_t::text) {
+            detail::write_text_row(sink.buffer, text_precision, i, columns...);
+        } else {
+            detail::write_binary_row(sink.buffer, format, quantization, i, columns...);
+        }
+        if ((sink.buffer.size() >= GP_WRITE_BUFFER_SIZE) && !this->flush_sink(sink)) {
+            break;
+        }
+    }
+    return !this->close_sink(sink).empty();
+}
 
-Gnuplot &Gnuplot::set_xlabel(const std::string &label)
+template <typename... Columns>
+std::string Gnuplot::write_columns(std::size_t rows, const Columns &...columns)
 {
-    std::ostringstream cmdstr;
+    // Non-arithmetic values can only be written as text, and datablocks can
+    // only hold text, binary data goes to a file instead.
+    const data_format_t format = detail::all_arithmetic<Columns...>::value ? data_format : data_format_t::text;
+    data_transport_t transport = data_transport;
+    if ((format != data_format_t::text) && (transport == data_transport_t::datablock)) {
+        transport = data_transport_t::file;
+    }
+    // Once Gnuplot failed to open a named pipe in time, files are used instead
+    // of waiting for it again at every plot.
+    if ((transport == data_transport_t::fifo) && fifo_stalled) {
+        transport = data_transport_t::file;
+    }
 
-    cmdstr << "set xlabel \"" << label << "\"";
-    this->send_cmd(cmdstr.str());
+    // Identical data, stored with the same encoding inside a file which is
+    // still alive, is reused as is.
+    std::uint64_t hash  = 0;
+    const bool cacheable = data_cache && (transport == data_transport_t::file) &&
+                           detail::hash_columns(hash, format, text_precision, rows, columns...);
+    if (cacheable) {
+        for (auto &tmpfile : tmpfile_list) {
+            if (tmpfile.cached && (tmpfile.hash == hash)) {
+                tmpfile.pending++;
+                tmpfile.last_use = ++tmpfile_clock;
+                cache_hits++;
+                return tmpfile.source;
+            }
+        }
+        cache_misses++;
+    }
 
-    return *this;
-}
+    // Quantized formats map each column over its own range.
+    const std::vector<detail::quantization_t> quantizations{ (format == data_format_t::binary_uint16)
+                                                                 ? detail::quantize(columns, rows)
+                                                                 : detail::quantization_t()... };
 
-Gnuplot &Gnuplot::set_ylabel(const std::string &label)
-{
-    std::ostringstream cmdstr;
+    data_sink_t sink;
+    if (!this->open_sink(sink, transport)) {
+        return std::string();
+    }
+    std::string source = (sink.transport == data_transport_t::datablock) ? sink.name : "\"" + sink.name + "\"";
+
+    if (sink.transport == data_transport_t::fifo) {
+        // The data is streamed once Gnuplot starts reading the pipe. The
+        // columns are still alive then, since the plotting function either
+        // sends the plot command or discards the writer before returning.
+        pending_writes.push_back(pending_write_t{
+            sink.name, [this, format, quantizations, rows, &columns...](data_sink_t &fifo) {
+                return this->write_records(fifo, format, quantizations.data(), rows, columns...);
+            } });
+    } else if (!this->write_records(sink, format, quantizations.data(), rows, columns...)) {
+        return std::string();
+    }
 
-    cmdstr << "set ylabel \"" << label << "\"";
-    this->send_cmd(cmdstr.str());
+    // Describe the layout of the binary records.
+    if (format != data_format_t::text) {
+        const char *formats[] = { detail::binary_format<detail::column_value_t<Columns>>(format)... };
+        source += " binary record=" + std::to_string(rows) + " format='";
+        for (const char *specifier : formats) {
+            source += specifier;
+        }
+        source += "'";
+    }
 
-    return *this;
+    // Tell Gnuplot how to read back each column.
+    for (std::size_t i = 0; i < quantizations.size(); ++i) {
+        source += (i == 0) ? " using " : ":";
+        source += detail::using_column(i + 1, format, quantizations[i]);
+    }
+
+    // Remember the content of the file.
+    tmpfile_t *tmpfile = cacheable ? this->find_tmpfile(sink.name) : nullptr;
+    if (tmpfile) {
+        tmpfile->cached = true;
+        tmpfile->hash   = hash;
+        tmpfile->source = source;
+    }
+    return source;
 }
 
-Gnuplot &Gnuplot::set_zlabel(const std::string &label)
+template <typename X>
+std::vector<std::string> Gnuplot::write_datasets(const std::vector<X> &datasets, const std::vector<size_t> &indices)
 {
-    std::ostringstream cmdstr;
+    using value_t = detail::column_value_t<X>;
+
+    // Every dataset is read from the same source, which rules out named pipes,
+    // and datablocks, as well as non-arithmetic values, can only hold text.
+    const data_format_t format = detail::all_arithmetic<X>::value ? data_format : data_format_t::text;
+    data_transport_t transport = data_transport;
+    if ((transport == data_transport_t::fifo) ||
+        ((format != data_format_t::text) && (transport == data_transport_t::datablock))) {
+        transport = data_transport_t::file;
+    }
 
-    cmdstr << "set zlabel \"" << label << "\"";
-    this->send_cmd(cmdstr.str());
+    // Binary records hold one column per dataset, shorter datasets are padded
+    // with NaN, which requires storing integral values as doubles.
+    size_t rows = 0;
+    for (size_t index : indices) {
+        rows = std::max(rows, datasets[index].size());
+    }
+    bool padded = false;
+    std::vector<detail::quantization_t> quantizations(indices.size());
+    for (size_t k = 0; k < indices.size(); ++k) {
+        const X &dataset = datasets[indices[k]];
+        padded           = padded || (dataset.size() != rows);
+        if (format == data_format_t::binary_uint16) {
+            quantizations[k] = detail::quantize(dataset, dataset.size());
+            quantizations[k].invalid |= (dataset.size() != rows);
+        }
+    }
 
-    return *this;
-}
+    data_sink_t sink;
+    if (!this->open_sink(sink, transport)) {
+        return std::vector<std::string>();
+    }
 
-Gnuplot &Gnuplot::set_xrange(const double iFrom, const double iTo)
-{
-    std::ostringstream cmdstr;
+    // Text data holds one block per dataset, selected with 'index'.
+    bool success = true;
+    sink.buffer.reserve(GP_WRITE_BUFFER_SIZE);
+    if (format == data_format_t::text) {
+        for (size_t k = 0; (k < indices.size()) && success; ++k) {
+            const X &dataset = datasets[indices[k]];
+            for (size_t i = 0; (i < dataset.size()) && success; ++i) {
+                detail::write_text_row(sink.buffer, text_precision, i, dataset);
+                if (sink.buffer.size() >= GP_WRITE_BUFFER_SIZE) {
+                    success = this->flush_sink(sink);
+                }
+            }
+            sink.buffer += "\n\n";
+        }
+    } else {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        for (size_t i = 0; (i < rows) && success; ++i) {
+            for (size_t k = 0; k < indices.size(); ++k) {
+                const X &dataset = datasets[indices[k]];
+                if (!padded) {
+                    detail::append_binary(sink.buffer, static_cast<value_t>(dataset[i]), format, quantizations[k]);
+                } else if (i < dataset.size()) {
+                    detail::append_binary(sink.buffer, detail::to_double(dataset[i]), format, quantizations[k]);
+                } else {
+                    detail::append_binary(sink.buffer, nan, format, quantizations[k]);
+                }
+            }
+            if (sink.buffer.size() >= GP_WRITE_BUFFER_SIZE) {
+                success = this->flush_sink(sink);
+            }
+        }
+    }
 
-    cmdstr << "set xrange[" << iFrom << ":" << iTo << "]";
-    this->send_cmd(cmdstr.str());
+    // Flush and close the destination
+    std::string source = this->close_sink(sink);
+    if (!success || source.empty()) {
+        return std::vector<std::string>();
+    }
 
-    return *this;
+    // Describe the layout of the binary records.
+    if (format != data_format_t::text) {
+        const char *specifier = padded ? detail::binary_format<double>(format) : detail::binary_format<value_t>(format);
+        source += " binary record=" + std::to_string(rows) + " format='";
+        for (size_t k = 0; k < indices.size(); ++k) {
+            source += specifier;
+        }
+        source += "'";
+    }
+
+    // Each dataset reads its own block or column of the shared source.
+    std::vector<std::string> sources(indices.size());
+    for (size_t k = 0; k < indices.size(); ++k) {
+        if (format == data_format_t::text) {
+            sources[k] = source + " index " + std::to_string(k) + " using 1";
+        } else {
+            sources[k] = source + " using " + detail::using_column(k + 1, format, quantizations[k]);
+        }
+    }
+    return sources;
 }
 
-Gnuplot &Gnuplot::set_yrange(const double iFrom, const double iTo)
+template <typename... Columns>
+dataset_t Gnuplot::create_dataset(const Columns &...columns)
 {
-    std::ostringstream cmdstr;
+    dataset_entry_t entry;
+    entry.id      = ++ndatasets;
+    entry.format  = !detail::all_arithmetic<Columns...>::value           ? data_format_t::text
+                    : (data_format == data_format_t::binary_uint16) ? data_format_t::binary
+                                                                    : data_format;
+    entry.columns = sizeof...(Columns);
+    entry.rows    = 0;
+    entry.version = 0;
+    entry.double_buffered = double_buffering;
+    if (!this->write_dataset(entry, dataset_write_t::create, columns...)) {
+        // No command ever read the file held for the dataset, delete it right away.
+        tmpfile_t *tmpfile = entry.name.empty() ? nullptr : this->find_tmpfile(entry.name);
+        if (tmpfile) {
+            this->release_bytes(*tmpfile);
+            detail::delete_tmpfile(tmpfile->name, tmpfile->fd);
+            Gnuplot::m_tmpfile_num--;
+            tmpfile_list.erase(tmpfile_list.begin() + (tmpfile - tmpfile_list.data()));
+        }
+        return dataset_t();
+    }
+    dataset_list.push_back(entry);
 
-    cmdstr << "set yrange[" << iFrom << ":" << iTo << "]";
-    this->send_cmd(cmdstr.str());
+    dataset_t dataset;
+    dataset.id = entry.id;
+    return dataset;
+}
 
+template <typename... Columns>
+Gnuplot &Gnuplot::append_dataset(const dataset_t &dataset, const Columns &...columns)
+{
+    dataset_entry_t *entry = this->find_dataset(dataset);
+    if (!entry) {
+        std::cerr << "Error: Invalid dataset. Cannot append.\n";
+        return *this;
+    }
+    if (this->write_dataset(*entry, dataset_write_t::append, columns...)) {
+        this->refresh_dataset(*entry);
+    }
     return *this;
 }
 
-Gnuplot &Gnuplot::set_zrange(const double iFrom, const double iTo)
+template <typename... Columns>
+Gnuplot &Gnuplot::update_dataset(const dataset_t &dataset, const Columns &...columns)
 {
-    std::ostringstream cmdstr;
-
-    cmdstr << "set zrange[" << iFrom << ":" << iTo << "]";
-    this->send_cmd(cmdstr.str());
-
+    dataset_entry_t *entry = this->find_dataset(dataset);
+    if (!entry) {
+        std::cerr << "Error: Invalid dataset. Cannot update.\n";
+        return *this;
+    }
+    if (this->write_dataset(*entry, dataset_write_t::replace, columns...)) {
+        this->refresh_dataset(*entry);
+    }
     return *this;
 }
 
-Gnuplot &Gnuplot::set_cbrange(const double iFrom, const double iTo)
+template <typename... Columns>
+Gnuplot &Gnuplot::update_dataset_range(const dataset_t &dataset, std::size_t first, const Columns &...columns)
 {
-    std::ostringstream cmdstr;
-
-    cmdstr << "set cbrange[" << iFrom << ":" << iTo << "]";
-    this->send_cmd(cmdstr.str());
+    dataset_entry_t *entry = this->find_dataset(dataset);
+    if (!entry) {
+        std::cerr << "Error: Invalid dataset. Cannot update.\n";
+        return *this;
+    }
+    std::string layout;
+    std::size_t rows = 0;
+    if (!this->check_dataset(*entry, false, layout, rows, columns...)) {
+        return *this;
+    }
+    if ((first > entry->rows) || (rows > entry->rows - first)) {
+        std::cerr << "Error: The updated records exceed the " << entry->rows << " records of the dataset.\n";
+        return *this;
+    }
+    if (rows == 0) {
+        return *this;
+    }
 
+    // Serialize the new records.
+    const std::vector<detail::quantization_t> quantizations(sizeof...(Columns));
+    std::string records;
+    for (std::size_t i = 0; i < rows; ++i) {
+        if (entry->format == data_format_t::text) {
+            detail::write_text_row(records, text_precision, i, columns...);
+        } else {
+            detail::write_binary_row(records, entry->format, quantizations.data(), i, columns...);
+        }
+    }
+    if (this->write_dataset_range(*entry, first, rows, records)) {
+        this->refresh_dataset(*entry);
+    }
     return *this;
 }
 
-bool Gnuplot::get_program_path()
+template <typename... Columns>
+bool Gnuplot::check_dataset(const dataset_entry_t &entry,
+                            bool create,
+                            std::string &layout,
+                            std::size_t &rows,
+                            const Columns &...columns)
 {
-    // Check the first location: `m_gnuplot_path`
-    std::string tmp = Gnuplot::m_gnuplot_path + "/" + Gnuplot::m_gnuplot_filename;
-
-    if (Gnuplot::file_exists(tmp, 1)) { // Check for existence and execution permission
-        return true;
+    // Check the shape of the records.
+    static_assert(sizeof...(Columns) > 0, "A dataset needs at least one column.");
+    const std::size_t sizes[] = { columns.size()... };
+    for (std::size_t size : sizes) {
+        if (size != sizes[0]) {
+            std::cerr << "Error: Mismatch between the lengths of the dataset columns.\n";
+            return false;
+        }
     }
-
-    // Check the second location: System PATH
-    char *path = getenv("PATH");
-    if (path == nullptr) {
-        std::cerr << "Error: PATH environment variable is not set.\n";
+    if (sizeof...(Columns) != entry.columns) {
+        std::cerr << "Error: The dataset has " << entry.columns << " columns.\n";
         return false;
     }
-
-    // Tokenize the PATH variable into directories
-    std::list<std::string> paths;
-#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__TOS_WIN__)
-    tokenize(paths, path, ";");
-#elif defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
-    tokenize(paths, path, ":");
-#endif
-
-    // Search for the Gnuplot executable in each directory
-    for (const auto &dir : paths) {
-        tmp = dir + "/" + Gnuplot::m_gnuplot_filename;
-        if (Gnuplot::file_exists(tmp, 1)) { // Check for existence and execution permission
-            Gnuplot::m_gnuplot_path = dir;  // Set `m_gnuplot_path`
-            return true;
+    rows = sizes[0];
+
+    // Binary records have no fixed count, Gnuplot reads them up to the end of the file.
+    layout.clear();
+    if (entry.format != data_format_t::text) {
+        const char *formats[] = { detail::binary_format<detail::column_value_t<Columns>>(entry.format)... };
+        layout = "binary format='";
+        for (const char *specifier : formats) {
+            layout += specifier;
         }
+        layout += "'";
     }
-
-    // Gnuplot was not found
-    std::cerr << "Error: Gnuplot not found in PATH or in \"" << Gnuplot::m_gnuplot_path << "\".\n";
-    return false;
+    if (!create && (layout != entry.layout)) {
+        std::cerr << "Error: The types of the columns differ from those of the dataset.\n";
+        return false;
+    }
+    return true;
 }
 
-bool Gnuplot::file_exists(const std::string &filename, int mode)
+template <typename... Columns>
+bool Gnuplot::write_dataset(dataset_entry_t &entry, dataset_write_t mode, const Columns &...columns)
 {
-    // Validate mode argument
-    if (mode < 0 || mode > 7) {
-        std::cerr << "Error: Invalid mode in Gnuplot::file_exists. Mode must be between 0 and 7.\n";
+    std::string layout;
+    std::size_t rows = 0;
+    data_sink_t sink;
+    if (!this->check_dataset(entry, mode == dataset_write_t::create, layout, rows, columns...) ||
+        !this->open_dataset_sink(entry, sink, mode, layout)) {
         return false;
     }
-
-    // Check file access using platform-independent macro
-    // mode = 0: Existence, 1: Execute, 2: Write, 4: Read
-    if (FILE_ACCESS(filename.c_str(), mode) == 0) {
-        return true; // File exists with the required mode
+    const std::vector<detail::quantization_t> quantizations(sizeof...(Columns));
+    const bool success = this->write_records(sink, entry.format, quantizations.data(), rows, columns...);
+    if (!this->publish_dataset_sink(entry, sink, success)) {
+        return false;
     }
+    entry.rows = (mode == dataset_write_t::append) ? entry.rows + rows : rows;
+    return true;
+}
 
-    // File does not exist or is inaccessible
-    return false;
+template <typename... Columns>
+bool Gnuplot::check_values(std::size_t rows, const Columns &...columns) const
+{
+    if (finite_check) {
+        const std::size_t counts[] = { detail::column_nonfinite(columns, rows)... };
+        std::size_t nonfinite      = 0;
+        for (std::size_t count : counts) {
+            nonfinite += count;
+        }
+        if (nonfinite > 0) {
+            std::cerr << "Error: The data holds " << nonfinite << " non-finite values. Cannot plot.\n";
+            return false;
+        }
+    }
+    if ((value_lower > -std::numeric_limits<double>::infinity()) ||
+        (value_upper < std::numeric_limits<double>::infinity())) {
+        const std::size_t counts[] = { detail::column_outside(columns, rows, value_lower, value_upper)... };
+        std::size_t outside        = 0;
+        for (std::size_t count : counts) {
+            outside += count;
+        }
+        if (outside > 0) {
+            std::cerr << "Error: The data holds " << outside << " values outside of [" << value_lower << ", "
+                      << value_upper << "]. Cannot plot.\n";
+            return false;
+        }
+    }
+    return true;
 }
 
-bool Gnuplot::is_line_style(plot_style_t style)
+template <typename X, typename Y>
+bool Gnuplot::decimate(const X &x, const Y &y, std::vector<std::size_t> &indices) const
 {
-    return (style == plot_style_t::lines || style == plot_style_t::lines_points || style == plot_style_t::steps ||
-            style == plot_style_t::fsteps || style == plot_style_t::histeps || style == plot_style_t::filled_curves ||
-            style == plot_style_t::impulses);
+    // Series which already fit the plot are written as they are.
+    const std::size_t limit = this->decimation_limit();
+    if ((limit == 0) || (x.size() <= limit)) {
+        return false;
+    }
+    indices.reserve(limit);
+    if (decimation == decimation_t::minmax) {
+        detail::decimate_minmax(x, y, decimation_size, indices);
+    } else {
+        detail::decimate_lttb(x, y, decimation_size, indices);
+    }
+    return indices.size() < x.size();
 }
 
-bool Gnuplot::is_point_style(plot_style_t style)
+std::size_t Gnuplot::decimation_limit() const
 {
-    return (style == plot_style_t::points || style == plot_style_t::lines_points);
+    // Min/max decimation writes up to four points per pixel column, LTTB one,
+    // and needs at least the first, the last and one point between them.
+    switch (decimation) {
+    case decimation_t::minmax:
+        return 4 * decimation_size;
+    case decimation_t::lttb:
+        return (decimation_size < 3) ? 0 : decimation_size;
+    default:
+        return 0;
+    }
 }
 
-bool Gnuplot::file_ready(const std::string &filename)
+template <typename X, typename Y, typename Z>
+std::string Gnuplot::write_grid(const X &x, const Y &y, const Z &z)
 {
-    // Check if the file exists.
-    if (Gnuplot::file_exists(filename, 0)) {
-        // Check if the file has read permissions.
-        if (Gnuplot::file_exists(filename, 4)) {
-            return true;
+    // Datablocks, as well as non-arithmetic values, can only hold text, and
+    // named pipes are not supported here
+    const data_format_t format = detail::all_arithmetic<X, Y, detail::column_value_t<Z>>::value ? data_format
+                                                                                                  : data_format_t::text;
+    data_transport_t transport = data_transport;
+    if ((transport == data_transport_t::fifo) ||
+        ((format != data_format_t::text) && (transport == data_transport_t::datablock))) {
+        transport = data_transport_t::file;
+    }
+
+    // Quantized formats map x, y and z over their own range
+    detail::quantization_t quantizations[3];
+    if (format == data_format_t::binary_uint16) {
+        quantizations[0] = detail::quantize(x, x.size());
+        quantizations[1] = detail::quantize(y, y.size());
+        double min = std::numeric_limits<double>::infinity(), max = -std::numeric_limits<double>::infinity();
+        bool finite = true;
+        for (size_t i = 0; i < x.size(); ++i) {
+            finite = detail::extend_range(z[i], y.size(), min, max) && finite;
         }
-        std::cerr << "No read permission for file \"" << filename << "\".";
-        return false;
+        quantizations[2] = detail::make_quantization(min, max, !finite);
     }
-    // File does not exist.
-    std::cerr << "File \"" << filename << "\" does not exist.";
-    return true;
+
+    // Open the destination of the grid data
+    data_sink_t sink;
+    if (!this->open_sink(sink, transport)) {
+        return std::string();
+    }
+
+    // Write the grid data
+    bool success = true;
+    sink.buffer.reserve(GP_WRITE_BUFFER_SIZE);
+    for (size_t i = 0; (i < x.size()) && success; ++i) {
+        const auto &row = z[i];
+        for (size_t j = 0; j < y.size(); ++j) {
+            if (format == data_format_t::text) {
+                detail::append_value(sink.buffer, x[i], text_precision);
+                sink.buffer.push_back(' ');
+                detail::append_value(sink.buffer, y[j], text_precision);
+                sink.buffer.push_back(' ');
+                detail::append_value(sink.buffer, row[j], text_precision);
+                sink.buffer.push_back('\n');
+            } else {
+                detail::append_binary(sink.buffer, x[i], format, quantizations[0]);
+                detail::append_binary(sink.buffer, y[j], format, quantizations[1]);
+                detail::append_binary(sink.buffer, row[j], format, quantizations[2]);
+            }
+        }
+        if (format == data_format_t::text) {
+            sink.buffer.push_back('\n'); // Separate rows for Gnuplot
+        }
+        if (sink.buffer.size() >= GP_WRITE_BUFFER_SIZE) {
+            success = this->flush_sink(sink);
+        }
+    }
+
+    // Flush and close the destination
+    std::string source = this->close_sink(sink);
+    if (!success || source.empty()) {
+        return std::string();
+    }
+
+    // Binary records are arranged as a grid, one scan for each x
+    if (format != data_format_t::text) {
+        source += " binary record=" + std::to_string(y.size()) + "x" + std::to_string(x.size()) + " format='";
+        source += detail::binary_format<detail::column_value_t<X>>(format);
+        source += detail::binary_format<detail::column_value_t<Y>>(format);
+        source += detail::binary_format<detail::column_value_t<detail::column_value_t<Z>>>(format);
+        source += "'";
+    }
+    for (std::size_t i = 0; i < 3; ++i) {
+        source += (i == 0) ? " using " : ":";
+        source += detail::using_column(i + 1, format, quantizations[i]);
+    }
+
+    return source;
 }
-std::string Gnuplot::create_tmpfile(std::ofstream &tmp)
-{
-#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__TOS_WIN__)
-    char filename[] = "gnuplotiXXXXXX"; // Temporary file in working directory
-#elif defined(unix) || defined(__unix) || defined(__unix__) || defined(__APPLE__)
-    char filename[] = "/tmp/gnuplotiXXXXXX"; // Temporary file in /tmp
-#endif
 
-    // Check if the maximum number of temporary files has been reached.
-    if (Gnuplot::m_tmpfile_num >= GP_MAX_TMP_FILES) {
-        std::cerr << "Error: Maximum number of temporary files reached (" << GP_MAX_TMP_FILES
-                  << "). Cannot create more files.\n";
-        return std::string(); // Return an empty string to indicate failure
+template <typename X, typename Y, typename Z>
+std::string Gnuplot::write_matrix(const X &x, const Y &y, const Z &z)
+{
+    // Binary matrices only hold single precision floats, and must go to a file.
+    const bool binary          = (data_format != data_format_t::text);
+    data_transport_t transport = data_transport;
+    if ((transport == data_transport_t::fifo) || (binary && (transport == data_transport_t::datablock))) {
+        transport = data_transport_t::file;
     }
 
-    // Generate a unique temporary filename.
-    if (CREATE_TEMP_FILE(filename)) {
-        std::cerr << "Error: Cannot create temporary file \"" << filename << "\".\n";
-        return std::string(); // Return an empty string to indicate failure
+    data_sink_t sink;
+    if (!this->open_sink(sink, transport)) {
+        return std::string();
     }
 
-    // Open the temporary file for writing.
-    tmp.open(filename);
-    if (!tmp.is_open() || tmp.bad()) {
-        std::cerr << "Error: Cannot open temporary file \"" << filename << "\" for writing.\n";
-        return std::string(); // Return an empty string to indicate failure
+    // The first row holds the number of columns followed by the y coordinates,
+    // each other row holds an x coordinate followed by the z values along y.
+    bool success = true;
+    sink.buffer.reserve(GP_WRITE_BUFFER_SIZE);
+    for (size_t i = 0; (i <= x.size()) && success; ++i) {
+        for (size_t j = 0; j <= y.size(); ++j) {
+            double value;
+            if (i == 0) {
+                value = (j == 0) ? static_cast<double>(y.size()) : detail::to_double(y[j - 1]);
+            } else {
+                value = (j == 0) ? detail::to_double(x[i - 1]) : detail::to_double(z[i - 1][j - 1]);
+            }
+            if (binary) {
+                detail::append_raw(sink.buffer, static_cast<float>(value));
+            } else {
+                if (j > 0) {
+                    sink.buffer.push_back(' ');
+                }
+                detail::append_value(sink.buffer, value, text_precision);
+            }
+        }
+        if (!binary) {
+            sink.buffer.push_back('\n');
+        }
+        if (sink.buffer.size() >= GP_WRITE_BUFFER_SIZE) {
+            success = this->flush_sink(sink);
+        }
     }
 
-    // Store the temporary file name for cleanup and increment the counter.
-    tmpfile_list.push_back(filename);
-    Gnuplot::m_tmpfile_num++;
+    // Flush and close the destination
+    std::string source = this->close_sink(sink);
+    if (!success || source.empty()) {
+        return std::string();
+    }
 
-    return filename; // Return the name of the successfully created temporary file
+    // Rows run along x, so the row and column coordinates are swapped back.
+    source += binary ? " binary matrix" : " nonuniform matrix";
+    source += " using 2:1:3";
+    return source;
 }
 
 Gnuplot &Gnuplot::apply_contour_settings()
@@ -1828,14 +4625,84 @@ void Gnuplot::remove_tmpfiles()
         return; // No temporary files to remove
     }
     for (const auto &tmpfile : tmpfile_list) {
-        if (std::remove(tmpfile.c_str()) != 0) {
-            std::cerr << "Warning: Unable to remove temporary file \"" << tmpfile << "\".\n";
+        if (!tmpfile.datablock) {
+            detail::delete_tmpfile(tmpfile.name, tmpfile.fd);
+            // Adjust the global temporary file counters
+            Gnuplot::m_tmpfile_num--;
+            Gnuplot::m_stats.bytes_stored -= tmpfile.size;
         }
     }
-    // Adjust the global temporary file counter
-    Gnuplot::m_tmpfile_num -= static_cast<int>(tmpfile_list.size());
+    session_stats.bytes_stored = 0;
     // Clear the list of temporary files
     tmpfile_list.clear();
 }
 
+void Gnuplot::update_tmpfiles(bool fresh)
+{
+    if (fresh) {
+        fresh_clock = tmpfile_clock;
+    }
+    for (auto &tmpfile : tmpfile_list) {
+        const bool used = tmpfile.used();
+        // A fresh plot drops the references of the previous chain of plots.
+        if (fresh) {
+            tmpfile.refs = 0;
+        }
+        tmpfile.refs += tmpfile.pending;
+        tmpfile.pending = 0;
+        if (used && !tmpfile.used()) {
+            tmpfile.last_use = ++tmpfile_clock;
+        }
+    }
+    this->trim_tmpfiles();
+}
+
+void Gnuplot::trim_tmpfiles()
+{
+    // Unreachable datablocks are undefined right away, they cannot be recycled.
+    // Unreachable files are sorted from the most to the least recently used.
+    std::vector<std::size_t> unused, evicted;
+    for (std::size_t i = 0; i < tmpfile_list.size(); ++i) {
+        if (tmpfile_list[i].used()) {
+            continue;
+        }
+        if (tmpfile_list[i].datablock) {
+            evicted.push_back(i);
+        } else {
+            unused.push_back(i);
+        }
+    }
+    if (unused.size() > tmpfile_pool_size) {
+        std::sort(unused.begin(), unused.end(), [this](std::size_t a, std::size_t b) {
+            return tmpfile_list[a].last_use > tmpfile_list[b].last_use;
+        });
+        // Files are only deleted once Gnuplot is done with them, the most
+        // recently used of the exceeding ones tells whether to wait for it.
+        if (!this->is_settled(tmpfile_list[unused[tmpfile_pool_size]])) {
+            this->sync_tmpfiles(false);
+        }
+        for (std::size_t i = tmpfile_pool_size; i < unused.size(); ++i) {
+            if (this->is_settled(tmpfile_list[unused[i]])) {
+                evicted.push_back(unused[i]);
+            }
+        }
+    }
+    // Delete them from the back of the list, to keep the indices valid.
+    std::sort(evicted.rbegin(), evicted.rend());
+    for (std::size_t index : evicted) {
+        tmpfile_t &tmpfile = tmpfile_list[index];
+        if (tmpfile.datablock) {
+            if (gnuplot_pipe) {
+                fprintf(gnuplot_pipe, "undefine %s\n", tmpfile.name.c_str());
+                fflush(gnuplot_pipe);
+            }
+        } else {
+            this->release_bytes(tmpfile);
+            detail::delete_tmpfile(tmpfile.name, tmpfile.fd);
+            Gnuplot::m_tmpfile_num--;
+        }
+        tmpfile_list.erase(tmpfile_list.begin() + static_cast<std::ptrdiff_t>(index));
+    }
+}
+
 } // namespace gnuplotcpp
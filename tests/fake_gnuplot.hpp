@@ -0,0 +1,138 @@
+/// @file fake_gnuplot.hpp
+/// @brief Stand-in Gnuplot executable recording the commands of the sessions, shared by the tests.
+/// @details The tests run without Gnuplot nor a display: a shell script named
+/// `gnuplot` is written to a fresh directory and selected with
+/// Gnuplot::set_gnuplot_path(). It appends every line it receives to a log,
+/// reads the scripts given to `load`, and writes the files given to
+/// `save terminal`, so that sessions checking whether Gnuplot is done with
+/// their files are answered.
+
+#pragma once
+
+#include <gnuplotcpp/gnuplot.hpp>
+
+#include <fcntl.h>    // for open()
+#include <sys/stat.h> // for chmod(), mkfifo()
+#include <unistd.h>   // for rmdir(), close()
+
+#include <fstream>
+
+/// @brief Number of failed checks so far.
+static int failures = 0;
+
+/// @brief Reports a failed check.
+#define CHECK(condition)                                                                                              \
+    do {                                                                                                               \
+        if (!(condition)) {                                                                                            \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": Check failed: " #condition "\n";                        \
+            failures++;                                                                                                \
+        }                                                                                                              \
+    } while (0)
+
+/// @brief Directory holding the stand-in executable and the log of the commands it received.
+class fake_gnuplot_t
+{
+public:
+    fake_gnuplot_t()
+    {
+        char directory[] = "/tmp/gnuplotcpp_test_XXXXXX";
+        if (!mkdtemp(directory)) {
+            std::cerr << "Cannot create the directory of the stand-in Gnuplot.\n";
+            std::exit(1);
+        }
+        path = directory;
+        std::ofstream script(path + "/gnuplot");
+        script << "#!/bin/sh\n"
+               << "while IFS= read -r line; do\n"
+               << "    printf '%s\\n' \"$line\" >> \"" << log_name() << "\"\n"
+               << "    case \"$line\" in\n"
+               << "    load\\ \\\"*) file=${line#load \\\"}; cat \"${file%\\\"}\" > /dev/null ;;\n"
+               << "    save\\ terminal\\ \\\"*) file=${line#save terminal \\\"}; echo 'set terminal dumb' > \"${file%\\\"}\" ;;\n"
+               << "    esac\n"
+               << "done\n";
+        script.close();
+        chmod((path + "/gnuplot").c_str(), 0700);
+        setenv("DISPLAY", ":0", 0);
+        gnuplotcpp::Gnuplot::set_gnuplot_path(path);
+    }
+
+    ~fake_gnuplot_t()
+    {
+        std::remove((path + "/gnuplot").c_str());
+        std::remove(log_name().c_str());
+        rmdir(path.c_str());
+    }
+
+    /// @brief Waits for the stand-in to have logged the commands sent so far by a session.
+    /// @details The session loads a named pipe, which the stand-in opens once
+    /// it has logged all the previous commands.
+    void sync(gnuplotcpp::Gnuplot &gnuplot)
+    {
+        const std::string name = path + "/sync";
+        if (mkfifo(name.c_str(), 0600) != 0) {
+            std::cerr << "Cannot create the named pipe synchronizing with the stand-in Gnuplot.\n";
+            std::exit(1);
+        }
+        gnuplot.send_cmd("load \"" + name + "\"");
+        const int fd = open(name.c_str(), O_WRONLY);
+        if (fd != -1) {
+            close(fd);
+        }
+        std::remove(name.c_str());
+    }
+
+    /// @brief Gives the name of the log of the commands.
+    std::string log_name() const
+    {
+        return path + "/commands.log";
+    }
+
+    /// @brief Gives the commands received since the last call, complete once the sessions sending them are closed.
+    std::vector<std::string> commands()
+    {
+        std::vector<std::string> lines;
+        std::ifstream log(log_name());
+        for (std::string line; std::getline(log, line);) {
+            lines.push_back(line);
+        }
+        log.close();
+        std::remove(log_name().c_str());
+        return lines;
+    }
+
+    /// @brief Gives the first command starting with the given prefix, received since the last call.
+    std::string find(const std::string &prefix)
+    {
+        for (const std::string &line : this->commands()) {
+            if (line.compare(0, prefix.size(), prefix) == 0) {
+                return line;
+            }
+        }
+        return std::string();
+    }
+
+    /// @brief Gives the rows of a datablock defined by the given commands.
+    /// @param index The position of the datablock among those defined, from zero.
+    static std::vector<std::string> datablock(const std::vector<std::string> &lines, std::size_t index = 0)
+    {
+        std::vector<std::string> rows;
+        bool inside = false;
+        for (const std::string &line : lines) {
+            if (!inside) {
+                inside = (line.size() > 7) && (line.compare(line.size() - 7, 7, " << EOD") == 0);
+            } else if (line != "EOD") {
+                rows.push_back(line);
+            } else if (index-- == 0) {
+                break;
+            } else {
+                inside = false;
+                rows.clear();
+            }
+        }
+        return rows;
+    }
+
+private:
+    /// @brief The directory of the stand-in executable.
+    std::string path;
+};
@@ -0,0 +1,116 @@
+/// @file test_commands.cpp
+/// @brief Checks the plot commands emitted by each plotting function for a given style.
+/// @details The data is sent as datablocks, so that the commands do not
+/// depend on the names of temporary files. The styles cover the options only
+/// given to lines, and those only given to points.
+
+#include "fake_gnuplot.hpp"
+
+using namespace gnuplotcpp;
+
+/// @brief Applies a style setting every option to a session.
+static void set_style(Gnuplot &gnuplot, plot_style_t style)
+{
+    gnuplot.set_data_transport(data_transport_t::datablock)
+        .set_plot_style(style)
+        .set_line_color("red")
+        .set_line_width(2)
+        .set_line_style(line_style_t::dashed)
+        .set_point_style(point_style_t::filled_circle)
+        .set_point_size(1.5);
+}
+
+/// @brief Runs a plotting function inside a fresh session, and gives the plot command it sent.
+template <typename Plot>
+static std::string emitted(fake_gnuplot_t &fake, plot_style_t style, const std::string &command, Plot plot)
+{
+    {
+        Gnuplot gnuplot;
+        set_style(gnuplot, style);
+        plot(gnuplot);
+    }
+    return fake.find(command);
+}
+
+int main()
+{
+    fake_gnuplot_t fake;
+
+    const std::vector<double> x{ 1, 2, 3 }, y{ 4, 5, 6 }, z{ 7, 8, 9 };
+    const std::vector<double> gx{ 0, 1 }, gy{ 0, 1 };
+    const std::vector<std::vector<double>> gz{ { 1, 2 }, { 3, 4 } };
+
+    // Every option is given to lines and points.
+    const std::string lines_points = " with linespoints lc rgb \"red\" lw 2 dashtype 2 pt 7 ps 1.5";
+    CHECK(emitted(fake, plot_style_t::lines_points, "plot", [&](Gnuplot &g) { g.plot_x(x, "a"); }) ==
+          "plot $gnuplot_data1 using 1 title \"a\"" + lines_points);
+    CHECK(emitted(fake, plot_style_t::lines_points, "plot", [&](Gnuplot &g) { g.plot_xy(x, y, "a"); }) ==
+          "plot $gnuplot_data1 using 1:2 title \"a\"" + lines_points);
+    CHECK(emitted(fake, plot_style_t::lines_points, "splot", [&](Gnuplot &g) { g.plot_xyz(x, y, z, "a"); }) ==
+          "splot $gnuplot_data1 using 1:2:3 title \"a\"" + lines_points);
+    CHECK(emitted(fake, plot_style_t::lines_points, "splot", [&](Gnuplot &g) { g.plot_3d_grid(gx, gy, gz, "a"); }) ==
+          "splot $gnuplot_data1 using 1:2:3 title \"a\"" + lines_points);
+    CHECK(emitted(fake, plot_style_t::lines_points, "plot", [&](Gnuplot &g) { g.plot_slope(1, 2, "a"); }) ==
+          "plot  1 * x + 2 title \"a\"" + lines_points);
+    CHECK(emitted(fake, plot_style_t::lines_points, "plot", [&](Gnuplot &g) { g.plot_equation("sin(x)", "a"); }) ==
+          "plot sin(x) title \"a\"" + lines_points);
+    CHECK(emitted(fake, plot_style_t::lines_points, "splot", [&](Gnuplot &g) { g.plot_equation3d("x*y", "a"); }) ==
+          "splot x*y title \"a\"" + lines_points);
+
+    // Styles without lines only get the color and the point options.
+    const std::string points = " with points lc rgb \"red\" pt 7 ps 1.5";
+    CHECK(emitted(fake, plot_style_t::points, "plot", [&](Gnuplot &g) { g.plot_x(x, "a"); }) ==
+          "plot $gnuplot_data1 using 1 title \"a\"" + points);
+    CHECK(emitted(fake, plot_style_t::points, "plot", [&](Gnuplot &g) { g.plot_xy(x, y, "a"); }) ==
+          "plot $gnuplot_data1 using 1:2 title \"a\"" + points);
+    CHECK(emitted(fake, plot_style_t::points, "plot", [&](Gnuplot &g) { g.plot_equation("sin(x)", "a"); }) ==
+          "plot sin(x) title \"a\"" + points);
+
+    // Several series get the same options as a single one.
+    const std::vector<std::vector<double>> series{ x, y };
+    const std::vector<std::string> titles{ "a", "b" }, untitled;
+    CHECK(emitted(fake, plot_style_t::lines_points, "plot", [&](Gnuplot &g) { g.plot_x(series, titles); }) ==
+          "plot $gnuplot_data1 index 0 using 1 title \"a\"" + lines_points +
+              ", $gnuplot_data1 index 1 using 1 title \"b\"" + lines_points);
+    CHECK(emitted(fake, plot_style_t::points, "plot", [&](Gnuplot &g) { g.plot_x(series, titles); }) ==
+          "plot $gnuplot_data1 index 0 using 1 title \"a\"" + points +
+              ", $gnuplot_data1 index 1 using 1 title \"b\"" + points);
+
+    // Plots without a title are followed by the same options.
+    CHECK(emitted(fake, plot_style_t::points, "plot", [&](Gnuplot &g) { g.plot_xy(x, y); }) ==
+          "plot $gnuplot_data1 using 1:2 notitle" + points);
+    CHECK(emitted(fake, plot_style_t::points, "plot", [&](Gnuplot &g) { g.plot_x(series, untitled); }) ==
+          "plot $gnuplot_data1 index 0 using 1 notitle" + points + ", $gnuplot_data1 index 1 using 1 notitle" + points);
+
+    // Binary records are described by the plot command, with the native type of each column.
+    {
+        Gnuplot gnuplot;
+        gnuplot.set_data_format(data_format_t::binary)
+            .plot_xyz(x, std::vector<float>{ 4, 5, 6 }, std::vector<int>{ 7, 8, 9 }, "a");
+    }
+    const std::string binary = fake.find("splot");
+    CHECK(binary.find("\" binary record=3 format='%double%float%int32' using 1:2:3 title \"a\"") !=
+          std::string::npos);
+    {
+        Gnuplot gnuplot;
+        gnuplot.set_data_format(data_format_t::binary_float32).plot_xy(x, y, "a");
+    }
+    CHECK(fake.find("plot").find("\" binary record=3 format='%float32%float32' using 1:2 title") != std::string::npos);
+
+    // Values which are not arithmetic are written as text, whatever the data format.
+    {
+        Gnuplot gnuplot;
+        gnuplot.set_data_transport(data_transport_t::datablock).set_data_format(data_format_t::binary);
+        gnuplot.plot_xy(std::vector<std::string>{ "1", "2" }, std::vector<double>{ 3, 4 }, "a");
+    }
+    const std::vector<std::string> text = fake.commands();
+    CHECK(fake_gnuplot_t::datablock(text) == (std::vector<std::string>{ "1 3", "2 4" }));
+    CHECK(std::find(text.begin(), text.end(), "plot $gnuplot_data1 using 1:2 title \"a\" with lines") != text.end());
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed.\n";
+        return 1;
+    }
+    std::cout << "The plot commands match.\n";
+    return 0;
+}
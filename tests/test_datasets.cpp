@@ -0,0 +1,173 @@
+/// @file test_datasets.cpp
+/// @brief Checks the records stored in the files of datasets as they are created, appended and updated.
+/// @details The name of the file of a dataset is taken from the plot command
+/// received by the stand-in Gnuplot, and the file is read back while the
+/// session is alive.
+
+#include "fake_gnuplot.hpp"
+
+#include <cstring>
+
+using namespace gnuplotcpp;
+
+/// @brief Gives the name of the file read by the last plot command sent by a session.
+static std::string plotted_file(fake_gnuplot_t &fake, Gnuplot &gnuplot)
+{
+    fake.sync(gnuplot);
+    std::string name;
+    for (const std::string &command : fake.commands()) {
+        if ((command.compare(0, 4, "plot") == 0) || (command.compare(0, 5, "splot") == 0)) {
+            const std::size_t first = command.find('"') + 1;
+            name                    = command.substr(first, command.find('"', first) - first);
+        }
+    }
+    return name;
+}
+
+/// @brief Reads the content of a file.
+static std::string read_file(const std::string &name)
+{
+    std::ifstream file(name.c_str(), std::ios::in | std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+/// @brief Checks that appended records are written after the existing ones.
+static void test_append(fake_gnuplot_t &fake)
+{
+    Gnuplot gnuplot;
+    const std::vector<double> x{ 1, 2, 3 }, y{ 4, 5, 6 };
+    dataset_t dataset = gnuplot.create_dataset(x, y);
+    CHECK(dataset.id != 0);
+    CHECK(gnuplot.get_dataset_version(dataset) == 0);
+
+    gnuplot.plot_dataset(dataset, "", "1:2");
+    const std::string name = plotted_file(fake, gnuplot);
+    CHECK(read_file(name) == "1 4\n2 5\n3 6\n");
+
+    // Only the new records are written, and the plot reading them is redrawn.
+    const unsigned long long written = gnuplot.get_storage_stats().bytes_written;
+    gnuplot.append_dataset(dataset, std::vector<double>{ 7 }, std::vector<double>{ 8 });
+    CHECK(read_file(name) == "1 4\n2 5\n3 6\n7 8\n");
+    CHECK(gnuplot.get_storage_stats().bytes_written == written + 4);
+    CHECK(gnuplot.get_dataset_version(dataset) == 1);
+    fake.sync(gnuplot);
+    CHECK(fake.find("replot") == "replot");
+
+    // Records of another shape are refused.
+    gnuplot.append_dataset(dataset, std::vector<double>{ 9 });
+    gnuplot.append_dataset(dataset, std::vector<double>{ 9 }, std::vector<double>{ 9, 10 });
+    CHECK(read_file(name) == "1 4\n2 5\n3 6\n7 8\n");
+    CHECK(gnuplot.get_dataset_version(dataset) == 1);
+
+    // Released datasets cannot be changed anymore.
+    gnuplot.remove_dataset(dataset);
+    CHECK(dataset.id == 0);
+    gnuplot.append_dataset(dataset, x, y);
+    CHECK(gnuplot.get_dataset_version(dataset) == 0);
+}
+
+/// @brief Gives the inode of a file, which changes when another file is renamed over it.
+static ino_t inode(const std::string &name)
+{
+    struct stat info;
+    return (stat(name.c_str(), &info) == 0) ? info.st_ino : 0;
+}
+
+/// @brief Checks that double buffered datasets are replaced by renaming a complete file over them.
+static void test_double_buffering(fake_gnuplot_t &fake)
+{
+    char buffer[] = "/tmp/gnuplotcpp_datasets_XXXXXX";
+    CHECK(mkdtemp(buffer) != nullptr);
+    const std::string directory = buffer;
+    {
+        Gnuplot gnuplot;
+        gnuplot.set_tmpfile_directory(directory).set_double_buffering(true);
+        dataset_t dataset = gnuplot.create_dataset(std::vector<double>{ 1, 2 }, std::vector<double>{ 3, 4 });
+        gnuplot.plot_dataset(dataset);
+        const std::string name = plotted_file(fake, gnuplot);
+        CHECK(name.compare(0, directory.size(), directory) == 0);
+        const ino_t original = inode(name);
+
+        // Readers of the old file keep reading the old records.
+        std::ifstream reader(name.c_str(), std::ios::in | std::ios::binary);
+        gnuplot.update_dataset(dataset, std::vector<double>{ 5, 6, 7 }, std::vector<double>{ 8, 9, 10 });
+        const std::string old_records((std::istreambuf_iterator<char>(reader)), std::istreambuf_iterator<char>());
+        CHECK(old_records == "1 3\n2 4\n");
+        CHECK(read_file(name) == "5 8\n6 9\n7 10\n");
+        CHECK(inode(name) != original);
+
+        // Range updates write the whole file again as well.
+        const ino_t updated = inode(name);
+        gnuplot.update_dataset_range(dataset, 1, std::vector<double>{ 0 }, std::vector<double>{ 0 });
+        CHECK(read_file(name) == "5 8\n0 0\n7 10\n");
+        CHECK(inode(name) != updated);
+        CHECK(gnuplot.get_dataset_version(dataset) == 2);
+
+        // No shadow file is left behind.
+        CHECK(gnuplot.get_storage_stats().files == 1);
+        CHECK(gnuplot.get_storage_stats().bytes_stored == read_file(name).size());
+        gnuplot.remove_dataset(dataset);
+    }
+    CHECK(rmdir(directory.c_str()) == 0);
+}
+
+/// @brief Checks that updates replace the records in place, and that binary range updates only write the range.
+static void test_update(fake_gnuplot_t &fake)
+{
+    Gnuplot gnuplot;
+    dataset_t text = gnuplot.create_dataset(std::vector<double>{ 1, 2, 3 }, std::vector<double>{ 4, 5, 6 });
+    gnuplot.plot_dataset(text);
+    const std::string text_name = plotted_file(fake, gnuplot);
+
+    // Text records are replaced as a whole, even when they change in length.
+    gnuplot.update_dataset(text, std::vector<double>{ 10, 20 }, std::vector<double>{ 30, 40 });
+    CHECK(read_file(text_name) == "10 30\n20 40\n");
+    gnuplot.update_dataset_range(text, 1, std::vector<double>{ 0.5 }, std::vector<double>{ 0.25 });
+    CHECK(read_file(text_name) == "10 30\n0.5 0.25\n");
+    CHECK(gnuplot.get_dataset_version(text) == 2);
+
+    // Ranges beyond the records are refused.
+    gnuplot.update_dataset_range(text, 2, std::vector<double>{ 1 }, std::vector<double>{ 1 });
+    gnuplot.update_dataset_range(text, 1, std::vector<double>{ 1, 2 }, std::vector<double>{ 1, 2 });
+    CHECK(read_file(text_name) == "10 30\n0.5 0.25\n");
+    CHECK(gnuplot.get_dataset_version(text) == 2);
+
+    // Binary records have a fixed size, a range is written over the old records.
+    gnuplot.set_data_format(data_format_t::binary).reset_plot();
+    dataset_t binary = gnuplot.create_dataset(std::vector<double>{ 1, 2, 3, 4 });
+    gnuplot.plot_dataset(binary);
+    const std::string binary_name = plotted_file(fake, gnuplot);
+    CHECK(read_file(binary_name).size() == 4 * sizeof(double));
+    const unsigned long long written = gnuplot.get_storage_stats().bytes_written;
+    gnuplot.update_dataset_range(binary, 2, std::vector<double>{ 9 });
+    CHECK(gnuplot.get_storage_stats().bytes_written == written + sizeof(double));
+    std::vector<double> values(4);
+    const std::string content = read_file(binary_name);
+    CHECK(content.size() == 4 * sizeof(double));
+    std::memcpy(values.data(), content.data(), std::min(content.size(), 4 * sizeof(double)));
+    CHECK((values[0] == 1) && (values[1] == 2) && (values[2] == 9) && (values[3] == 4));
+    CHECK(gnuplot.get_dataset_version(binary) == 1);
+
+    // Columns of another type than those of the dataset are refused.
+    gnuplot.update_dataset(binary, std::vector<float>{ 1, 2, 3, 4 });
+    CHECK(gnuplot.get_dataset_version(binary) == 1);
+
+    gnuplot.remove_dataset(text);
+    gnuplot.remove_dataset(binary);
+}
+
+int main()
+{
+    fake_gnuplot_t fake;
+
+    test_append(fake);
+    test_double_buffering(fake);
+    test_update(fake);
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed.\n";
+        return 1;
+    }
+    std::cout << "The datasets hold the expected records.\n";
+    return 0;
+}
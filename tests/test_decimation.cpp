@@ -0,0 +1,348 @@
+/// @file test_decimation.cpp
+/// @brief Checks the points kept by the decimation modes, and how many of them are written.
+/// @details The kernels are run on series where the expected points can be
+/// found by brute force, then plots are sent to the stand-in Gnuplot as
+/// datablocks, whose rows are counted.
+
+#include "fake_gnuplot.hpp"
+
+#include <random>
+
+using namespace gnuplotcpp;
+
+/// @brief Checks that indices are strictly increasing, and start and end with the series.
+static bool is_increasing(const std::vector<std::size_t> &indices, std::size_t rows)
+{
+    if (indices.empty() || (indices.front() != 0) || (indices.back() != rows - 1)) {
+        return false;
+    }
+    for (std::size_t i = 1; i < indices.size(); ++i) {
+        if (indices[i - 1] >= indices[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Checks whether an index was kept.
+static bool is_kept(const std::vector<std::size_t> &indices, std::size_t index)
+{
+    return std::binary_search(indices.begin(), indices.end(), index);
+}
+
+/// @brief Checks the min/max decimation kernel.
+static void test_minmax(std::mt19937 &random)
+{
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    const std::size_t rows = 10000, columns = 100;
+    std::vector<double> x(rows), y(rows);
+    for (std::size_t i = 0; i < rows; ++i) {
+        x[i] = static_cast<double>(i);
+        y[i] = uniform(random);
+    }
+    y[4321] = 10.0;
+
+    // At most four points per column, holding the extremes of each column.
+    std::vector<std::size_t> indices;
+    detail::decimate_minmax(x, y, columns, indices);
+    CHECK(is_increasing(indices, rows));
+    CHECK(indices.size() <= 4 * columns);
+    CHECK(is_kept(indices, 4321));
+    const double scale = static_cast<double>(columns) / static_cast<double>(rows - 1);
+    for (std::size_t first = 0; first < rows;) {
+        const std::size_t column = std::min(static_cast<std::size_t>(x[first] * scale), columns - 1);
+        std::size_t end = first, lowest = first, highest = first;
+        for (; (end < rows) && (std::min(static_cast<std::size_t>(x[end] * scale), columns - 1) == column); ++end) {
+            lowest  = (y[end] < y[lowest]) ? end : lowest;
+            highest = (y[end] > y[highest]) ? end : highest;
+        }
+        CHECK(is_kept(indices, first) && is_kept(indices, end - 1));
+        CHECK(is_kept(indices, lowest) && is_kept(indices, highest));
+        first = end;
+    }
+
+    // Non-finite values are kept, and split the run of their column.
+    y[500] = std::numeric_limits<double>::quiet_NaN();
+    x[700] = std::numeric_limits<double>::infinity();
+    indices.clear();
+    detail::decimate_minmax(x, y, columns, indices);
+    CHECK(is_increasing(indices, rows));
+    CHECK(is_kept(indices, 499) && is_kept(indices, 500) && is_kept(indices, 501));
+    CHECK(is_kept(indices, 700));
+
+    // A series with a single x coordinate falls in one column, split by the NaN.
+    std::vector<double> same(rows, 1.0);
+    indices.clear();
+    detail::decimate_minmax(same, y, columns, indices);
+    CHECK(is_increasing(indices, rows));
+    CHECK(indices.size() <= 9);
+}
+
+/// @brief Checks the number of points written by min/max decimated plots.
+static void test_minmax_plot(fake_gnuplot_t &fake)
+{
+    std::vector<double> x(2000), y(2000);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        x[i] = static_cast<double>(i);
+        y[i] = static_cast<double>(i % 7);
+    }
+    // Series longer than four points per column are reduced.
+    {
+        Gnuplot gnuplot;
+        gnuplot.set_data_transport(data_transport_t::datablock).set_decimation(decimation_t::minmax, 100);
+        gnuplot.plot_xy(x, y);
+    }
+    const std::size_t reduced = fake_gnuplot_t::datablock(fake.commands()).size();
+    CHECK((reduced > 0) && (reduced <= 400));
+    // The others are written as they are.
+    {
+        Gnuplot gnuplot;
+        gnuplot.set_data_transport(data_transport_t::datablock).set_decimation(decimation_t::minmax, 500);
+        gnuplot.plot_xy(x, y);
+    }
+    CHECK(fake_gnuplot_t::datablock(fake.commands()).size() == x.size());
+    // Without decimation, every point is written.
+    {
+        Gnuplot gnuplot;
+        gnuplot.set_data_transport(data_transport_t::datablock).set_decimation(decimation_t::none, 100);
+        gnuplot.plot_xy(x, y);
+    }
+    CHECK(fake_gnuplot_t::datablock(fake.commands()).size() == x.size());
+}
+
+/// @brief Checks the LTTB decimation kernel.
+static void test_lttb(std::mt19937 &random)
+{
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    const std::size_t rows = 10000, points = 100;
+    std::vector<double> x(rows), y(rows);
+    for (std::size_t i = 0; i < rows; ++i) {
+        x[i] = static_cast<double>(i);
+        y[i] = uniform(random);
+    }
+
+    // Exactly one point per bucket, between the first and the last points.
+    std::vector<std::size_t> indices;
+    detail::decimate_lttb(x, y, points, indices);
+    CHECK(indices.size() == points);
+    CHECK(is_increasing(indices, rows));
+    const double every = static_cast<double>(rows - 2) / static_cast<double>(points - 2);
+    for (std::size_t i = 1; i + 1 < indices.size(); ++i) {
+        CHECK(indices[i] >= static_cast<std::size_t>(static_cast<double>(i - 1) * every) + 1);
+        CHECK(indices[i] < static_cast<std::size_t>(static_cast<double>(i) * every) + 1);
+    }
+
+    // On a flat series, the bucket holding a spike keeps it.
+    std::vector<double> flat(rows, 0.0);
+    flat[4321] = 1.0;
+    indices.clear();
+    detail::decimate_lttb(x, flat, points, indices);
+    CHECK(indices.size() == points);
+    CHECK(is_kept(indices, 4321));
+
+    // Buckets next to one without finite points still keep their spikes:
+    // 1050 is measured against the point kept before, 1300 against the last
+    // finite kept point, instead of NaN areas keeping the first points.
+    flat[1050] = 1.0;
+    flat[1300] = 1.0;
+    for (std::size_t i = 1123; i < 1225; ++i) {
+        flat[i] = std::numeric_limits<double>::quiet_NaN();
+    }
+    indices.clear();
+    detail::decimate_lttb(x, flat, points, indices);
+    CHECK(indices.size() == points);
+    CHECK(is_increasing(indices, rows));
+    CHECK(is_kept(indices, 1050) && is_kept(indices, 1300) && is_kept(indices, 4321));
+}
+
+/// @brief Checks the number of points written by LTTB decimated plots.
+static void test_lttb_plot(fake_gnuplot_t &fake)
+{
+    std::vector<double> x(2000), y(2000);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        x[i] = static_cast<double>(i);
+        y[i] = static_cast<double>(i % 7);
+    }
+    // One point per column.
+    {
+        Gnuplot gnuplot;
+        gnuplot.set_data_transport(data_transport_t::datablock).set_decimation(decimation_t::lttb, 100);
+        gnuplot.plot_xy(x, y);
+    }
+    CHECK(fake_gnuplot_t::datablock(fake.commands()).size() == 100);
+    // plot_x uses the index of each value as its x coordinate.
+    {
+        Gnuplot gnuplot;
+        gnuplot.set_data_transport(data_transport_t::datablock).set_decimation(decimation_t::lttb, 100);
+        gnuplot.plot_x(y);
+    }
+    CHECK(fake_gnuplot_t::datablock(fake.commands()).size() == 100);
+    // Fewer than three columns cannot keep the first and last points, and a point between them.
+    {
+        Gnuplot gnuplot;
+        gnuplot.set_data_transport(data_transport_t::datablock).set_decimation(decimation_t::lttb, 2);
+        gnuplot.plot_xy(x, y);
+    }
+    CHECK(fake_gnuplot_t::datablock(fake.commands()).size() == x.size());
+}
+
+/// @brief Checks the envelope decimation kernel of error bars.
+static void test_envelope(std::mt19937 &random)
+{
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    const std::size_t rows = 10000, columns = 100;
+    std::vector<double> x(rows), y(rows), dy(rows);
+    for (std::size_t i = 0; i < rows; ++i) {
+        x[i]  = static_cast<double>(i);
+        y[i]  = uniform(random);
+        dy[i] = uniform(random) * 0.5;
+    }
+
+    // One bar per column, from the lowest to the highest end of its bars.
+    std::vector<double> envelope[4];
+    CHECK(detail::decimate_envelope(x, y, dy, columns, envelope));
+    CHECK(envelope[0].size() == columns);
+    const double scale = static_cast<double>(columns) / static_cast<double>(rows - 1);
+    std::size_t bar    = 0;
+    for (std::size_t first = 0; (first < rows) && (bar < envelope[0].size()); ++bar) {
+        const std::size_t column = std::min(static_cast<std::size_t>(x[first] * scale), columns - 1);
+        double sum_x = 0.0, sum_y = 0.0, low = y[first] - std::fabs(dy[first]), high = y[first] + std::fabs(dy[first]);
+        std::size_t end = first;
+        for (; (end < rows) && (std::min(static_cast<std::size_t>(x[end] * scale), columns - 1) == column); ++end) {
+            sum_x += x[end];
+            sum_y += y[end];
+            low  = std::min(low, y[end] - std::fabs(dy[end]));
+            high = std::max(high, y[end] + std::fabs(dy[end]));
+        }
+        const double count = static_cast<double>(end - first);
+        CHECK(std::fabs(envelope[0][bar] - sum_x / count) < 1e-9);
+        CHECK(std::fabs(envelope[1][bar] - sum_y / count) < 1e-9);
+        CHECK((envelope[2][bar] == low) && (envelope[3][bar] == high));
+        first = end;
+    }
+    CHECK(bar == columns);
+
+    // Bars with a non-finite value are kept on their own, and split the bar of their column.
+    y[550] = std::numeric_limits<double>::quiet_NaN();
+    for (auto &values : envelope) {
+        values.clear();
+    }
+    CHECK(detail::decimate_envelope(x, y, dy, columns, envelope));
+    CHECK(envelope[0].size() == columns + 2);
+    CHECK(std::find(envelope[0].begin(), envelope[0].end(), 550.0) != envelope[0].end());
+}
+
+/// @brief Checks the number of bars written by decimated error bar plots.
+static void test_envelope_plot(fake_gnuplot_t &fake)
+{
+    std::vector<double> x(2000), y(2000), dy(2000, 0.1);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        x[i] = static_cast<double>(i);
+        y[i] = static_cast<double>(i % 7);
+    }
+    // One bar per column whatever the mode, with its lowest and highest ends.
+    for (decimation_t mode : { decimation_t::minmax, decimation_t::lttb }) {
+        {
+            Gnuplot gnuplot;
+            gnuplot.set_data_transport(data_transport_t::datablock).set_decimation(mode, 100);
+            gnuplot.plot_xy_erorrbar(x, y, dy, erorrbar_style_t::yerrorbars);
+        }
+        const std::vector<std::string> rows = fake_gnuplot_t::datablock(fake.commands());
+        CHECK(rows.size() == 100);
+        CHECK(!rows.empty() && (std::count(rows[0].begin(), rows[0].end(), ' ') == 3));
+    }
+    // Series which fit the plot, and x error bars, are written as they are.
+    {
+        Gnuplot gnuplot;
+        gnuplot.set_data_transport(data_transport_t::datablock).set_decimation(decimation_t::lttb, 2000);
+        gnuplot.plot_xy_erorrbar(x, y, dy, erorrbar_style_t::yerrorbars);
+    }
+    CHECK(fake_gnuplot_t::datablock(fake.commands()).size() == x.size());
+    {
+        Gnuplot gnuplot;
+        gnuplot.set_data_transport(data_transport_t::datablock).set_decimation(decimation_t::minmax, 100);
+        gnuplot.plot_xy_erorrbar(x, y, dy, erorrbar_style_t::xerrorbars);
+    }
+    CHECK(fake_gnuplot_t::datablock(fake.commands()).size() == x.size());
+}
+
+/// @brief Checks the points of the windows plotted from a pyramid.
+static void test_pyramid(fake_gnuplot_t &fake)
+{
+    const std::size_t rows = 100000;
+    std::vector<double> x(rows), y(rows);
+    for (std::size_t i = 0; i < rows; ++i) {
+        x[i] = static_cast<double>(i);
+        y[i] = static_cast<double>(i % 13);
+    }
+    y[54321] = 100.0;
+    y[1001]  = 200.0;
+    y[1005]  = -50.0;
+    y[90011] = -70.0;
+
+    // The pyramid shares the series, the caller can drop its own references.
+    std::shared_ptr<const std::vector<double>> shared_x = std::make_shared<const std::vector<double>>(std::move(x));
+    std::shared_ptr<const std::vector<double>> shared_y = std::make_shared<const std::vector<double>>(std::move(y));
+    {
+        Gnuplot gnuplot;
+        gnuplot.set_data_transport(data_transport_t::datablock).set_decimation(decimation_t::minmax, 100);
+        pyramid_t pyramid = gnuplot.create_pyramid(shared_x, shared_y);
+        CHECK(pyramid.id != 0);
+        CHECK(gnuplot.create_pyramid(shared_x, nullptr).id == 0);
+        shared_x.reset();
+        shared_y.reset();
+        gnuplot.plot_pyramid(pyramid, 1000.0, 1200.0);
+        gnuplot.reset_plot().plot_pyramid(pyramid, 0.0, static_cast<double>(rows));
+        gnuplot.reset_plot().plot_pyramid(pyramid, 1003.5, 90008.5);
+        gnuplot.set_decimation(decimation_t::none).reset_plot().plot_pyramid(pyramid, 50000.0, 60000.0);
+        gnuplot.remove_pyramid(pyramid);
+        CHECK(pyramid.id == 0);
+    }
+    const std::vector<std::string> commands = fake.commands();
+    const std::vector<std::string> small    = fake_gnuplot_t::datablock(commands, 0);
+    const std::vector<std::string> large    = fake_gnuplot_t::datablock(commands, 1);
+    const std::vector<std::string> clipped  = fake_gnuplot_t::datablock(commands, 2);
+    const std::vector<std::string> all      = fake_gnuplot_t::datablock(commands, 3);
+
+    // Windows fitting the plot keep all their points, and their outer neighbours.
+    CHECK(small.size() == 203);
+    CHECK(!small.empty() && (small.front() == "999 11") && (small.back() == "1201 5"));
+
+    // Larger ones keep the extremes of at most two blocks per column, spikes included.
+    CHECK((large.size() > 100) && (large.size() <= 400));
+    CHECK(std::find(large.begin(), large.end(), "54321 100") != large.end());
+
+    // Blocks crossing the edges of the window only keep the points inside it,
+    // with its outer neighbours.
+    CHECK((clipped.size() > 100) && (clipped.size() <= 400));
+    CHECK(!clipped.empty() && (clipped.front().compare(0, 5, "1003 ") == 0));
+    CHECK(!clipped.empty() && (clipped.back().compare(0, 6, "90009 ") == 0));
+    CHECK(std::find(clipped.begin(), clipped.end(), "1001 200") == clipped.end());
+    CHECK(std::find(clipped.begin(), clipped.end(), "1005 -50") != clipped.end());
+    CHECK(std::find(clipped.begin(), clipped.end(), "90011 -70") == clipped.end());
+    CHECK(std::find(clipped.begin(), clipped.end(), "54321 100") != clipped.end());
+
+    // Without decimation, every point of the window is written.
+    CHECK(all.size() == 10003);
+}
+
+int main()
+{
+    fake_gnuplot_t fake;
+    std::mt19937 random(12345);
+
+    test_minmax(random);
+    test_minmax_plot(fake);
+    test_lttb(random);
+    test_lttb_plot(fake);
+    test_envelope(random);
+    test_envelope_plot(fake);
+    test_pyramid(fake);
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed.\n";
+        return 1;
+    }
+    std::cout << "The decimation modes keep the expected points.\n";
+    return 0;
+}
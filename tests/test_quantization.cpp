@@ -0,0 +1,80 @@
+/// @file test_quantization.cpp
+/// @brief Checks that values stored as 16-bit codes are read back within half a step.
+/// @details The values are encoded as the binary_uint16 format writes them,
+/// then decoded the way the `using` expression of their column does.
+
+#include "fake_gnuplot.hpp"
+
+#include <cstring>
+#include <random>
+
+using namespace gnuplotcpp;
+
+/// @brief Encodes the values of a column, and decodes them back.
+static std::vector<double> round_trip(const std::vector<double> &values, detail::quantization_t &quantization)
+{
+    quantization = detail::quantize(values, values.size());
+    std::string buffer;
+    for (double value : values) {
+        detail::append_binary(buffer, value, data_format_t::binary_uint16, quantization);
+    }
+    CHECK(buffer.size() == values.size() * sizeof(std::uint16_t));
+
+    std::vector<double> decoded;
+    for (std::size_t i = 0; i + sizeof(std::uint16_t) <= buffer.size(); i += sizeof(std::uint16_t)) {
+        std::uint16_t code;
+        std::memcpy(&code, buffer.data() + i, sizeof(code));
+        decoded.push_back((code == GP_QUANTIZED_INVALID) ? std::numeric_limits<double>::quiet_NaN()
+                                                         : code * quantization.scale + quantization.offset);
+    }
+    return decoded;
+}
+
+int main()
+{
+    std::mt19937 random(12345);
+    std::uniform_real_distribution<double> uniform(-3.0, 7.0);
+    detail::quantization_t quantization;
+
+    // Finite values are read back within half a step, the extremes exactly.
+    std::vector<double> values(10000);
+    for (auto &v : values) {
+        v = uniform(random);
+    }
+    values[10] = -3.5;
+    values[20] = 7.5;
+    std::vector<double> decoded = round_trip(values, quantization);
+    CHECK(decoded.size() == values.size());
+    CHECK(!quantization.invalid);
+    CHECK(std::fabs(quantization.scale - 11.0 / (GP_QUANTIZED_INVALID - 1)) < 1e-15);
+    for (std::size_t i = 0; i < decoded.size(); ++i) {
+        CHECK(std::fabs(decoded[i] - values[i]) <= quantization.scale * 0.5 + 1e-12);
+    }
+    CHECK(std::fabs(decoded[10] - values[10]) < 1e-12);
+    CHECK(std::fabs(decoded[20] - values[20]) < 1e-12);
+    CHECK(detail::using_column(2, data_format_t::binary_uint16, quantization).find("NaN") == std::string::npos);
+
+    // Non-finite values are marked, and restored as NaN by the using expression.
+    values[30] = std::numeric_limits<double>::quiet_NaN();
+    values[40] = std::numeric_limits<double>::infinity();
+    decoded    = round_trip(values, quantization);
+    CHECK(quantization.invalid);
+    CHECK(std::isnan(decoded[30]) && std::isnan(decoded[40]));
+    CHECK(std::fabs(decoded[20] - values[20]) < 1e-12);
+    CHECK(detail::using_column(2, data_format_t::binary_uint16, quantization).find("$2==65535?NaN:") !=
+          std::string::npos);
+
+    // A constant column is read back exactly.
+    decoded = round_trip(std::vector<double>(100, 42.0), quantization);
+    CHECK((decoded.size() == 100) && (decoded.front() == 42.0) && (decoded.back() == 42.0));
+
+    // Other formats read the column as it is.
+    CHECK(detail::using_column(2, data_format_t::binary, quantization) == "2");
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed.\n";
+        return 1;
+    }
+    std::cout << "The quantized values round-trip.\n";
+    return 0;
+}
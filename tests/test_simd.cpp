@@ -0,0 +1,165 @@
+/// @file test_simd.cpp
+/// @brief Checks the vector kernels scanning arrays of values against their scalar versions.
+/// @details The kernels are run on random arrays holding ties, NaN and
+/// infinities, at every size and alignment of the tails, and must give the
+/// same results as the scalar loops. Their throughput is only printed when
+/// the test is run with `--benchmark`.
+
+#include <gnuplotcpp/gnuplot.hpp>
+
+#include <chrono>
+#include <random>
+
+using namespace gnuplotcpp;
+
+/// @brief Number of mismatches found so far.
+static int failures = 0;
+
+/// @brief Reports a mismatch between a kernel and the scalar loop.
+static void check(bool success, const char *kernel, const char *type, std::size_t size, std::size_t offset)
+{
+    if (!success) {
+        std::cerr << "Mismatch: " << kernel << " on " << size << " " << type << " values at offset " << offset
+                  << "\n";
+        failures++;
+    }
+}
+
+/// @brief Fills an array with small integers, so that ties are frequent, and some non-finite values.
+template <typename T>
+static std::vector<T> make_values(std::size_t size, std::mt19937 &random)
+{
+    std::uniform_int_distribution<int> value(-50, 50), special(0, 15);
+    std::vector<T> values(size);
+    for (auto &v : values) {
+        switch (special(random)) {
+        case 0:
+            v = std::numeric_limits<T>::quiet_NaN();
+            break;
+        case 1:
+            v = std::numeric_limits<T>::infinity();
+            break;
+        case 2:
+            v = -std::numeric_limits<T>::infinity();
+            break;
+        default:
+            v = static_cast<T>(value(random)) / static_cast<T>(4);
+            break;
+        }
+    }
+    return values;
+}
+
+/// @brief Compares the kernels of one instruction set with the scalar loops, on the array [data, data + size).
+template <typename T, typename Scan, typename Extrema, typename Outside>
+static void compare(const char *name,
+                    const char *type,
+                    const T *data,
+                    std::size_t size,
+                    std::size_t offset,
+                    Scan scan,
+                    Extrema extrema,
+                    Outside outside)
+{
+    double min = std::numeric_limits<double>::infinity(), max = -std::numeric_limits<double>::infinity();
+    double vmin = min, vmax = max;
+    const std::size_t nonfinite = detail::scan_range_scalar(data, 0, size, min, max);
+    check((scan(data, size, vmin, vmax) == nonfinite) && (vmin == min) && (vmax == max), name, type, size, offset);
+
+    std::size_t lowest = 0, highest = 0, vlowest = 0, vhighest = 0;
+    const std::size_t skipped = detail::find_extrema_scalar(data, 0, size, lowest, highest);
+    check((extrema(data, size, vlowest, vhighest) == skipped) && (vlowest == lowest) && (vhighest == highest), name,
+          type, size, offset);
+
+    const std::size_t count = detail::count_outside_scalar(data, 0, size, -5.0, 7.5);
+    check(outside(data, size, -5.0, 7.5) == count, name, type, size, offset);
+}
+
+/// @brief Compares every available instruction set with the scalar loops, on arrays of the given type.
+template <typename T>
+static void compare_all(const char *type, std::mt19937 &random)
+{
+    for (std::size_t size = 0; size <= 4099; size += (size < 64) ? 1 : 1009) {
+        const std::vector<T> values = make_values<T>(size + 3, random);
+        // Start at every offset, to cover unaligned loads.
+        for (std::size_t offset = 0; offset < 4; ++offset) {
+            const T *data = values.data() + offset;
+            const std::size_t length = std::min(size, values.size() - offset);
+#if defined(GP_USE_SIMD)
+            compare("sse2", type, data, length, offset, detail::scan_range_sse2<T>, detail::find_extrema_sse2<T>,
+                    detail::count_outside_sse2<T>);
+#endif
+#if defined(GP_USE_AVX2)
+            if (detail::simd_support() == detail::simd_t::avx2) {
+                compare("avx2", type, data, length, offset, detail::scan_range_avx2<T>,
+                        detail::find_extrema_avx2<T>, detail::count_outside_avx2<T>);
+            }
+#endif
+            compare("dispatch", type, data, length, offset, detail::scan_range<T>, detail::find_extrema<T>,
+                    detail::count_outside<T>);
+        }
+    }
+}
+
+/// @brief Prints the throughput of a kernel, in millions of values per second.
+template <typename Kernel>
+static void measure(const char *name, const std::vector<double> &values, Kernel kernel)
+{
+    const int repeats = 20;
+    std::size_t sink  = 0;
+    const auto start  = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        sink += kernel(values.data(), values.size());
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "  " << name << ": "
+              << static_cast<double>(values.size()) * repeats / elapsed.count() / 1e6 << " Mvalues/s"
+              << ((sink == 0) ? " " : "") << "\n";
+}
+
+/// @brief Prints the throughput of the range scan of each instruction set, on values which are all finite.
+static void benchmark(std::mt19937 &random)
+{
+    std::vector<double> values(1 << 22);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    for (auto &v : values) {
+        v = uniform(random);
+    }
+    std::cout << "Range scan of " << values.size() << " doubles:\n";
+    measure("scalar", values, [](const double *data, std::size_t size) {
+        double min = 0, max = 0;
+        return detail::scan_range_scalar(data, 0, size, min, max) + static_cast<std::size_t>(max > min);
+    });
+#if defined(GP_USE_SIMD)
+    measure("sse2", values, [](const double *data, std::size_t size) {
+        double min = 0, max = 0;
+        return detail::scan_range_sse2(data, size, min, max) + static_cast<std::size_t>(max > min);
+    });
+#endif
+#if defined(GP_USE_AVX2)
+    if (detail::simd_support() == detail::simd_t::avx2) {
+        measure("avx2", values, [](const double *data, std::size_t size) {
+            double min = 0, max = 0;
+            return detail::scan_range_avx2(data, size, min, max) + static_cast<std::size_t>(max > min);
+        });
+    }
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    std::mt19937 random(12345);
+    compare_all<double>("double", random);
+    compare_all<float>("float", random);
+
+    if ((argc > 1) && (std::string(argv[1]) == "--benchmark")) {
+        benchmark(random);
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " mismatches.\n";
+        return 1;
+    }
+    std::cout << "The kernels match the scalar loops.\n";
+    return 0;
+}
@@ -0,0 +1,227 @@
+/// @file test_tmpfiles.cpp
+/// @brief Checks how the temporary files holding the data of the plots are recycled, reused and deleted.
+/// @details The sessions plot to the stand-in Gnuplot, which answers their
+/// requests to be told when it is done with their files. The files are
+/// observed through the storage counters of the sessions.
+
+#include "fake_gnuplot.hpp"
+
+#include <dirent.h>   // for opendir()
+#include <sys/wait.h> // for waitpid()
+
+using namespace gnuplotcpp;
+
+/// @brief Gives the number of files of a session.
+static std::size_t files(const Gnuplot &gnuplot)
+{
+    return gnuplot.get_storage_stats().files;
+}
+
+/// @brief Checks that unused files are recycled, and that the pool keeps at most the given number of them.
+static void
+test_pool(fake_gnuplot_t &fake, const std::vector<double> &x, const std::vector<double> &y, const std::vector<double> &z)
+{
+    Gnuplot gnuplot;
+    gnuplot.set_tmpfile_pool_size(1);
+
+    // Released files are kept for recycling.
+    gnuplot.plot_xy(x, y).reset_plot();
+    CHECK(files(gnuplot) == 1);
+
+    // Files Gnuplot may still read are not recycled, a new one is created.
+    gnuplot.plot_xy(x, z);
+    CHECK(files(gnuplot) == 2);
+
+    // Releasing it exceeds the pool, the least recently used file is deleted
+    // by a later plot, once Gnuplot is done with it.
+    gnuplot.reset_plot();
+    CHECK(files(gnuplot) <= 2);
+    fake.sync(gnuplot);
+    gnuplot.set_tmpfile_pool_size(1);
+    CHECK(files(gnuplot) == 1);
+
+    // Gnuplot is done with the remaining one, it is recycled.
+    const storage_stats_t before = gnuplot.get_storage_stats();
+    gnuplot.plot_xy(x, y);
+    const storage_stats_t after = gnuplot.get_storage_stats();
+    CHECK(after.files == 1);
+    CHECK(after.bytes_written > before.bytes_written);
+    CHECK(after.bytes_stored == after.bytes_written - before.bytes_written);
+
+    // Files read by the current plot are kept, whatever the size of the pool.
+    gnuplot.set_tmpfile_pool_size(0);
+    CHECK(files(gnuplot) == 1);
+
+    // Without a pool, released files are deleted as soon as Gnuplot is done with them.
+    gnuplot.reset_plot();
+    fake.sync(gnuplot);
+    gnuplot.set_tmpfile_pool_size(0);
+    CHECK(files(gnuplot) == 0);
+    CHECK(gnuplot.get_storage_stats().bytes_stored == 0);
+}
+
+/// @brief Checks that identical data is written once, and counted as a cache hit.
+static void test_cache(const std::vector<double> &x, const std::vector<double> &y, const std::vector<double> &z)
+{
+    Gnuplot gnuplot;
+    gnuplot.set_data_cache(true);
+
+    gnuplot.plot_xy(x, y);
+    CHECK((gnuplot.get_cache_hits() == 0) && (gnuplot.get_cache_misses() == 1));
+    const unsigned long long written = gnuplot.get_storage_stats().bytes_written;
+
+    // The same data, even after the file was released, reuses the file.
+    gnuplot.reset_plot().plot_xy(x, y);
+    CHECK((gnuplot.get_cache_hits() == 1) && (gnuplot.get_cache_misses() == 1));
+    CHECK(gnuplot.get_storage_stats().bytes_written == written);
+    CHECK(files(gnuplot) == 1);
+
+    // Other data is written to another file.
+    gnuplot.plot_xy(x, z);
+    CHECK((gnuplot.get_cache_hits() == 1) && (gnuplot.get_cache_misses() == 2));
+    CHECK(files(gnuplot) == 2);
+
+    // The format is part of the content.
+    gnuplot.set_data_format(data_format_t::binary).plot_xy(x, y);
+    CHECK((gnuplot.get_cache_hits() == 1) && (gnuplot.get_cache_misses() == 3));
+
+    // Without the cache, nothing is counted.
+    Gnuplot uncached;
+    uncached.plot_xy(x, y).plot_xy(x, y);
+    CHECK((uncached.get_cache_hits() == 0) && (uncached.get_cache_misses() == 0));
+    CHECK(files(uncached) == 2);
+}
+
+/// @brief Checks that the quota evicts the files no plot reads, and refuses data which does not fit.
+static void
+test_quota(fake_gnuplot_t &fake, const std::vector<double> &x, const std::vector<double> &y, const std::vector<double> &z)
+{
+    fake.commands();
+    Gnuplot gnuplot;
+    gnuplot.plot_xy(x, y);
+    const unsigned long long size = gnuplot.get_storage_stats().bytes_stored;
+    gnuplot.reset_plot();
+    CHECK(files(gnuplot) == 1);
+
+    // The released file is evicted to make room for the new one.
+    gnuplot.set_tmpfile_quota(static_cast<std::size_t>(size * 3 / 2));
+    gnuplot.plot_xy(x, z);
+    CHECK(files(gnuplot) == 1);
+    CHECK(gnuplot.get_storage_stats().bytes_stored <= size * 3 / 2);
+
+    // Files read by the current plot are never evicted, the data is refused.
+    const unsigned long long written = gnuplot.get_storage_stats().bytes_written;
+    gnuplot.plot_xy(x, y);
+    const storage_stats_t refused = gnuplot.get_storage_stats();
+    CHECK(refused.bytes_stored <= size * 3 / 2);
+    CHECK(refused.bytes_written < written + size);
+
+    // Without a quota, both fit.
+    gnuplot.set_tmpfile_quota(0).plot_xy(x, y);
+    CHECK(gnuplot.get_storage_stats().bytes_stored > size * 3 / 2);
+
+    // The refused plot was not sent.
+    fake.sync(gnuplot);
+    std::size_t plots = 0;
+    for (const std::string &command : fake.commands()) {
+        plots += ((command.compare(0, 5, "plot ") == 0) || (command.compare(0, 7, "replot ") == 0)) ? 1 : 0;
+    }
+    CHECK(plots == 3);
+}
+
+/// @brief Lists the names of the files of a directory.
+static std::vector<std::string> list_directory(const std::string &directory)
+{
+    std::vector<std::string> names;
+    DIR *dir = opendir(directory.c_str());
+    while (const struct dirent *entry = dir ? readdir(dir) : nullptr) {
+        if (entry->d_name[0] != '.') {
+            names.push_back(entry->d_name);
+        }
+    }
+    if (dir) {
+        closedir(dir);
+    }
+    return names;
+}
+
+/// @brief Checks that the sweeper only deletes the files of dead processes of the same boot and PID namespace.
+static void test_sweeper(const std::vector<double> &x, const std::vector<double> &y)
+{
+    char buffer[] = "/tmp/gnuplotcpp_sweep_XXXXXX";
+    CHECK(mkdtemp(buffer) != nullptr);
+    const std::string directory = buffer;
+    CHECK(Gnuplot::set_default_tmpfile_directory(directory));
+
+    // A process leaves the file of a double buffered dataset, which has a name, behind.
+    const pid_t child = fork();
+    if (child == 0) {
+        Gnuplot gnuplot;
+        gnuplot.set_double_buffering(true).create_dataset(x, y);
+        _exit(0);
+    }
+    CHECK((child > 0) && (waitpid(child, nullptr, 0) == child));
+    const std::vector<std::string> orphans = list_directory(directory);
+    CHECK(orphans.size() == 1);
+    if (orphans.size() != 1) {
+        Gnuplot::set_default_tmpfile_directory("");
+        return;
+    }
+    const std::string orphan = orphans[0];
+    const std::string prefix = orphan.substr(0, orphan.find('-') + 1);
+    CHECK(orphan.find("-" + std::to_string(child) + "-") != std::string::npos);
+
+    // Files of live processes, and of other boots or namespaces, are kept.
+    const std::string alive   = prefix + "1-abcdef";
+    const std::string foreign = "gnuploti0000000000000000-" + std::to_string(child) + "-abcdef";
+    std::ofstream(directory + "/" + alive).put('\n');
+    std::ofstream(directory + "/" + foreign).put('\n');
+    {
+        Gnuplot gnuplot;
+        dataset_t dataset = gnuplot.set_double_buffering(true).create_dataset(x, y);
+        CHECK(list_directory(directory).size() == 4);
+        CHECK(Gnuplot::sweep_orphaned_tmpfiles() == 1);
+        const std::vector<std::string> kept = list_directory(directory);
+        CHECK(kept.size() == 3);
+        CHECK(std::find(kept.begin(), kept.end(), orphan) == kept.end());
+        CHECK(std::find(kept.begin(), kept.end(), alive) != kept.end());
+        CHECK(std::find(kept.begin(), kept.end(), foreign) != kept.end());
+        gnuplot.remove_dataset(dataset);
+    }
+
+    // Sweeping again finds nothing.
+    CHECK(Gnuplot::sweep_orphaned_tmpfiles() == 0);
+    std::remove((directory + "/" + alive).c_str());
+    std::remove((directory + "/" + foreign).c_str());
+    CHECK(list_directory(directory).empty());
+    rmdir(directory.c_str());
+    Gnuplot::set_default_tmpfile_directory("");
+}
+
+int main()
+{
+    fake_gnuplot_t fake;
+
+    std::vector<double> x(100), y(100), z(100);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        x[i] = static_cast<double>(i);
+        y[i] = static_cast<double>(i) * 0.5;
+        z[i] = -static_cast<double>(i);
+    }
+
+    test_pool(fake, x, y, z);
+    test_cache(x, y, z);
+    test_quota(fake, x, y, z);
+    test_sweeper(x, y);
+
+    // Every file is deleted with its session.
+    CHECK(Gnuplot::get_process_storage_stats().files == 0);
+    CHECK(Gnuplot::get_process_storage_stats().bytes_stored == 0);
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed.\n";
+        return 1;
+    }
+    std::cout << "The temporary files are managed as expected.\n";
+    return 0;
+}
@@ -0,0 +1,59 @@
+/// @file test_transport.cpp
+/// @brief Checks how plots fall back to temporary files when Gnuplot does not read their named pipes.
+/// @details The stand-in Gnuplot never opens the named pipes given to its plot
+/// commands, as a Gnuplot failing to execute them would.
+
+#include "fake_gnuplot.hpp"
+
+#include <chrono>
+
+using namespace gnuplotcpp;
+
+/// @brief Gives the name of the data read by a plot command.
+static std::string plotted_name(const std::string &command)
+{
+    const std::size_t first = command.find('"') + 1;
+    return command.substr(first, command.find('"', first) - first);
+}
+
+/// @brief Gives the number of seconds taken by a plot.
+template <typename Plot>
+static double seconds(Plot plot)
+{
+    const auto start = std::chrono::steady_clock::now();
+    plot();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main()
+{
+    fake_gnuplot_t fake;
+    const std::vector<double> x{ 1, 2, 3 }, y{ 4, 5, 6 };
+
+    Gnuplot gnuplot;
+    gnuplot.set_data_transport(data_transport_t::fifo);
+
+    // The first plot waits for Gnuplot to open its pipe, then removes it.
+    CHECK(seconds([&] { gnuplot.plot_xy(x, y); }) >= GP_FIFO_TIMEOUT_MS / 1000.0);
+    fake.sync(gnuplot);
+    const std::string fifo = plotted_name(fake.find("plot"));
+    struct stat info;
+    CHECK(!fifo.empty() && (stat(fifo.c_str(), &info) != 0));
+
+    // The following plots do not wait again, they use temporary files.
+    CHECK(seconds([&] { gnuplot.plot_xy(x, y); }) < GP_FIFO_TIMEOUT_MS / 1000.0);
+    fake.sync(gnuplot);
+    const std::string file = plotted_name(fake.find("replot"));
+    CHECK((stat(file.c_str(), &info) == 0) && S_ISREG(info.st_mode));
+
+    // Setting the transport again gives named pipes another chance.
+    gnuplot.set_data_transport(data_transport_t::fifo).reset_plot();
+    CHECK(seconds([&] { gnuplot.plot_xy(x, y); }) >= GP_FIFO_TIMEOUT_MS / 1000.0);
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed.\n";
+        return 1;
+    }
+    std::cout << "The plots fall back to temporary files.\n";
+    return 0;
+}